@@ -2,19 +2,34 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <utility>
+#include <iosfwd>
+#if __cplusplus > 201703L
+#include <compare>
+#endif
 
 using namespace std;
 
+#if defined(__SIZEOF_INT128__) && !defined(BIGINT_32BIT_LIMBS)
+typedef unsigned long long limb_t;
+__extension__ typedef unsigned __int128 double_limb_t;
+#else
+typedef unsigned int limb_t;
+typedef unsigned long long double_limb_t;
+#endif
+
 struct big_integer {
 
 	big_integer();
 	big_integer(big_integer const& other);
+	big_integer(big_integer&& other) noexcept;
 	big_integer(int a);
-	big_integer(std::vector<unsigned int> const&, bool);
-	explicit big_integer(std::string const& str);
+	big_integer(std::vector<limb_t> const&, bool);
+	explicit big_integer(std::string const& str, int base = 10);
 	~big_integer();
 
 	big_integer& operator=(big_integer const& other);
+	big_integer& operator=(big_integer&& other) noexcept;
 
 	big_integer& operator+=(big_integer const& rhs);
 	big_integer& operator-=(big_integer const& rhs);
@@ -39,65 +54,122 @@ struct big_integer {
 	big_integer& operator--();
 	big_integer operator--(int);
 
+	big_integer square() const;
+
+	limb_t divrem_1(limb_t d);
+
+	size_t bit_length() const;
+	size_t popcount() const;
+	size_t count_trailing_zeros() const;
+	bool test_bit(size_t i) const;
+	big_integer& set_bit(size_t i);
+	big_integer& clear_bit(size_t i);
+	big_integer& flip_bit(size_t i);
+
+	big_integer& addmul(big_integer const& a, big_integer const& b);
+	big_integer& submul(big_integer const& a, big_integer const& b);
+	big_integer& addmul(big_integer const& a, int b);
+	big_integer& submul(big_integer const& a, int b);
+
 	friend bool operator==(big_integer const& a, big_integer const& b);
 	friend bool operator!=(big_integer const& a, big_integer const& b);
 	friend bool operator<(big_integer const& a, big_integer const& b);
 	friend bool operator>(big_integer const& a, big_integer const& b);
 	friend bool operator<=(big_integer const& a, big_integer const& b);
 	friend bool operator>=(big_integer const& a, big_integer const& b);
+	friend int compare(big_integer const& a, big_integer const& b);
+#if __cplusplus > 201703L
+	friend std::strong_ordering operator<=>(big_integer const& a, big_integer const& b);
+#endif
+
+	friend std::string to_string(big_integer const& a, int base);
+	friend size_t to_chars_size(big_integer const& a, int base);
+	friend char* to_chars(char* first, char* last, big_integer const& a, int base);
+	friend std::ostream& operator<<(std::ostream& s, big_integer const& a);
+
+	friend std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b);
 
-	friend std::string to_string(big_integer const& a);
+	friend big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod);
 
-	void swap(big_integer& a);
+	friend big_integer divexact(big_integer const& a, big_integer const& b);
+
+	void swap(big_integer& a) noexcept;
+
+	friend struct big_divisor;
+	friend struct montgomery_context;
 
 private:
-	vector<unsigned int> data;
+	vector<limb_t> data;
 
 	bool isNegate;
 
-	void mul_vector_by_const(std::vector<unsigned int>& res, std::vector<unsigned int> const & a, unsigned int const& b);
+	void mul_vector_by_const(std::vector<limb_t>& res, std::vector<limb_t> const & a, limb_t const& b);
 
-	big_integer do_division(big_integer const&, big_integer const&);
+	void do_division(big_integer const&, big_integer const&, big_integer&, big_integer&);
 
-	big_integer bin_pow(int);
+	void shift_limbs(size_t);
 
-	void division_by_const(unsigned int);
+	size_t first_nonzero_limb() const;
 
-	void add_zero(int, vector <unsigned int>&);
+	void invert();
 
-	void add_module(big_integer const& a, big_integer const& b, vector <unsigned int>& tmp);
+	void assign_magnitude_bit(size_t, bool);
 
-	void subtract_module(big_integer const& a, big_integer const& b, vector <unsigned int>& tmp);
+	void divide_3n2n(big_integer const&, big_integer const&, size_t, big_integer&, big_integer&);
 
-	unsigned int make_normalized(big_integer&, big_integer&);
+	void divide_2n1n(big_integer const&, big_integer const&, size_t, big_integer&, big_integer&);
 
-	void make_equal(size_t, vector<unsigned int>&, vector<unsigned int>&);
+	void divide_bz(big_integer const&, big_integer const&, big_integer&, big_integer&);
 
-	void convert(vector <unsigned int>&, bool);
+	big_integer reciprocal(big_integer const&, size_t);
 
-	void do_and(vector<unsigned int> &, vector <unsigned int> const&);
+	void divide_newton(big_integer const&, big_integer const&, big_integer&, big_integer&);
 
-	void do_or(vector <unsigned int> &, vector <unsigned int> const&);
+	void divide_module(big_integer const&, big_integer const&, big_integer&, big_integer&);
 
-	void do_xor(vector <unsigned int> &, vector <unsigned int> const&);
+	void divide_signed(big_integer const&, big_integer&);
 
-	void multiply_by_const(unsigned int cnt);
+	char* write_digits(char*, int, big_integer const*, size_t, size_t) const;
+	char* write_digits(char*, int) const;
+	size_t digits_bound(int) const;
+	size_t magnitude_bits() const;
+	void assign_digits(char const*, size_t, int, big_integer const*, size_t);
+	void assign_bits(char const*, size_t, int);
 
-	bool compare_module(big_integer const& a, big_integer const& b) const;
+	big_integer bin_pow(int);
 
-	void make_positive(big_integer&);
+	void division_by_const(limb_t);
+
+	void toom3(vector<limb_t>&, vector<limb_t> const&, vector<limb_t> const&) const;
 
-	bool is_deg2();
+	void mul_magnitude(vector<limb_t>&, vector<limb_t> const&, vector<limb_t> const&) const;
 
-	void correct();
+	void add_module(big_integer const& b);
+
+	bool subtract_module(big_integer const& b);
+
+	void add_limbs_signed(vector<limb_t> const& p, bool negative);
+
+	void addmul_const(big_integer const& a, limb_t b, bool negative);
+
+	limb_t make_normalized(big_integer&, big_integer&);
+
+	template <typename Op>
+	big_integer& bitwise(big_integer const&, Op);
+
+	void multiply_by_const(limb_t cnt);
+
+	bool compare_module(big_integer const& a, big_integer const& b) const;
+
+	void make_positive(big_integer&);
 
 	void divide_by_32();
 
-	unsigned int calculate(unsigned int, unsigned int, unsigned int);
+	limb_t calculate(limb_t, limb_t, limb_t);
 
-	bool compare_equal_vectors(vector<unsigned int> const &, vector<unsigned int> const &);
+	bool compare_equal_vectors(vector<limb_t> const &, vector<limb_t> const &);
 
-	void sub_equal_vectors(vector<unsigned int> &, vector<unsigned int> const &);
+	void sub_equal_vectors(vector<limb_t> &, vector<limb_t> const &);
 };
 
 big_integer operator+(big_integer a, big_integer const& b);
@@ -106,6 +178,15 @@ big_integer operator*(big_integer a, big_integer const& b);
 big_integer operator/(big_integer a, big_integer const& b);
 big_integer operator%(big_integer a, big_integer const& b);
 
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b);
+
+big_integer pow(big_integer const& base, unsigned exp);
+
+// base^exp mod |mod| in [0, |mod|), exp must not be negative
+big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod);
+
+big_integer divexact(big_integer const& a, big_integer const& b);
+
 big_integer operator&(big_integer a, big_integer const& b);
 big_integer operator|(big_integer a, big_integer const& b);
 big_integer operator^(big_integer a, big_integer const& b);
@@ -120,6 +201,67 @@ bool operator>(big_integer const& a, big_integer const& b);
 bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
-string to_string(big_integer const& a);
+// -1, 0 or 1 as a is less than, equal to or greater than b
+int compare(big_integer const& a, big_integer const& b);
+#if __cplusplus > 201703L
+std::strong_ordering operator<=>(big_integer const& a, big_integer const& b);
+#endif
+
+// digits beyond 9 are lower case letters, the string constructor takes either case
+string to_string(big_integer const& a, int base = 10);
+
+// exactly the number of characters to_chars writes for a, the sign included
+size_t to_chars_size(big_integer const& a, int base = 10);
+// writes a in the given base without a terminating zero, returns the end of the written characters or 0 if they do not fit
+char* to_chars(char* first, char* last, big_integer const& a, int base = 10);
 
 ostream& operator<<(std::ostream& s, big_integer const& a);
+
+// divisor reused for many divisions, keeps it normalized together with floor(B^(2n) / d) for Barrett reduction,
+// long divisors go to the ordinary division
+struct big_divisor {
+
+	explicit big_divisor(big_integer const& d);
+
+	big_integer div(big_integer const& a) const;
+	big_integer mod(big_integer const& a) const;
+	std::pair<big_integer, big_integer> divmod(big_integer const& a) const;
+
+private:
+	big_integer value;
+
+	vector<limb_t> divisor;
+
+	vector<limb_t> inverse;
+
+	size_t n;
+
+	limb_t f;
+
+	bool negative;
+
+	void divide_block(limb_t*, limb_t*, limb_t*) const;
+};
+
+// arithmetic modulo an odd m on residues in Montgomery form a * R mod m, R = B^n
+struct montgomery_context {
+
+	explicit montgomery_context(big_integer const& m);
+
+	big_integer to_montgomery(big_integer const& a) const;
+	big_integer from_montgomery(big_integer const& a) const;
+
+	big_integer multiply(big_integer const& a, big_integer const& b) const;
+	big_integer square(big_integer const& a) const;
+
+private:
+	big_integer modulus;
+
+	big_integer r2;
+
+	size_t n;
+
+	limb_t m_inv;
+
+	big_integer redc(vector<limb_t>&) const;
+};
@@ -1,9 +1,13 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 #include <utility>
 #include <gtest/gtest.h>
+#include <gmpxx.h>
+#include <iomanip>
+#include <sstream>
 
 #include "big_integer.h"
 
@@ -680,3 +684,613 @@ TEST(correctness, mul_merge_randomized)
         EXPECT_TRUE(a == b);
     }
 }
+
+namespace
+{
+    std::string random_number(size_t digits)
+    {
+        std::string s(1, (char)('1' + rand() % 9));
+        for (size_t i = 1; i != digits; ++i)
+            s += (char)('0' + rand() % 10);
+        if (rand() % 2)
+            s = "-" + s;
+        return s;
+    }
+
+    void check_mul(std::string const& a, std::string const& b)
+    {
+        mpz_class expected = mpz_class(a) * mpz_class(b);
+        EXPECT_EQ(to_string(big_integer(a) * big_integer(b)), expected.get_str());
+    }
+}
+
+TEST(correctness, mul_karatsuba_gmp)
+{
+    size_t const sizes[] = {300, 350, 700, 1000, 2900};
+    for (size_t i = 0; i != sizeof(sizes) / sizeof(sizes[0]); ++i)
+        for (size_t j = 0; j <= i; ++j)
+            check_mul(random_number(sizes[i]), random_number(sizes[j]));
+
+    big_integer a(random_number(1500));
+    mpz_class b(to_string(a));
+    a *= a;
+    EXPECT_EQ(to_string(a), mpz_class(b * b).get_str());
+}
+
+namespace
+{
+    // y * x^k, built from multiplications by the short x only
+    big_integer mul_by_power(big_integer y, big_integer const& x, unsigned k)
+    {
+        for (unsigned i = 0; i != k; ++i)
+            y *= x;
+        return y;
+    }
+}
+
+TEST(correctness, mul_toom3)
+{
+    check_mul(random_number(15000), random_number(15000));
+
+    big_integer x(random_number(2000)), y(random_number(2000));
+    big_integer a = mul_by_power(1, x, 15);
+    big_integer b = mul_by_power(y, x, 20);
+    EXPECT_EQ(a * b, mul_by_power(y, x, 35));
+    EXPECT_EQ(a * a, mul_by_power(1, x, 30));
+}
+
+TEST(correctness, mul_ntt)
+{
+    big_integer x(random_number(2000)), y(random_number(2000));
+    big_integer a = mul_by_power(1, x, 40);
+    big_integer b = mul_by_power(y, x, 36);
+    EXPECT_EQ(a * b, mul_by_power(y, x, 76));
+    EXPECT_EQ(a.square(), mul_by_power(1, x, 80));
+}
+
+TEST(correctness, square)
+{
+    EXPECT_EQ(big_integer(-7).square(), 49);
+    EXPECT_EQ(big_integer(0).square(), 0);
+
+    std::string s = random_number(700);
+    mpz_class expected = mpz_class(s) * mpz_class(s);
+    EXPECT_EQ(to_string(big_integer(s).square()), expected.get_str());
+
+    size_t const sizes[] = {100, 1000, 16000, 40000};
+    for (size_t i = 0; i != sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        big_integer a(random_number(sizes[i]));
+        big_integer b = a;
+        big_integer c = a * b;
+        EXPECT_EQ(a.square(), c);
+        b *= b;
+        EXPECT_EQ(b, c);
+    }
+}
+
+TEST(correctness, move_ctor)
+{
+    big_integer a("123456789012345678901234567890123456789012345678901234567890");
+    big_integer b = std::move(a);
+    EXPECT_EQ(b, big_integer("123456789012345678901234567890123456789012345678901234567890"));
+
+    EXPECT_EQ(a, 0);
+    EXPECT_EQ(compare(a, 0), 0);
+    EXPECT_EQ(to_string(a), "0");
+    big_integer c = std::move(b);
+    b += 1;
+    EXPECT_EQ(b, 1);
+
+    a = 5;
+    EXPECT_EQ(a, 5);
+}
+
+TEST(correctness, move_assignment)
+{
+    big_integer a("-123456789012345678901234567890123456789012345678901234567890");
+    big_integer b = 7;
+    b = std::move(a);
+    EXPECT_EQ(b, big_integer("-123456789012345678901234567890123456789012345678901234567890"));
+
+    b = std::move(b);
+    b = big_integer(3) * 4;
+    EXPECT_EQ(b, 12);
+}
+
+TEST(correctness, swap)
+{
+    big_integer a("-123456789012345678901234567890123456789012345678901234567890");
+    big_integer b = 42;
+    a.swap(b);
+    EXPECT_EQ(a, 42);
+    EXPECT_EQ(b, big_integer("-123456789012345678901234567890123456789012345678901234567890"));
+
+    std::swap(a, b);
+    EXPECT_EQ(b, 42);
+    EXPECT_EQ(a, big_integer("-123456789012345678901234567890123456789012345678901234567890"));
+}
+
+TEST(correctness, add_sub_in_place)
+{
+    big_integer a("340282366920938463463374607431768211455");
+    big_integer b = a;
+    a += 1;
+    EXPECT_EQ(a, big_integer("340282366920938463463374607431768211456"));
+    a -= 1;
+    EXPECT_EQ(a, b);
+    a -= a;
+    EXPECT_EQ(a, 0);
+    b += b;
+    EXPECT_EQ(b, big_integer("680564733841876926926749214863536422910"));
+
+    big_integer c = 5;
+    c -= big_integer("100000000000000000000000000000000");
+    EXPECT_EQ(c, big_integer("-99999999999999999999999999999995"));
+    c += big_integer("99999999999999999999999999999995");
+    EXPECT_EQ(c, 0);
+    EXPECT_EQ(to_string(c), "0");
+}
+
+TEST(correctness, add_to_shrunk_copy)
+{
+    big_integer x = (big_integer(1) << 576) + 5;
+    x -= big_integer(1) << 576;
+    big_integer s = x;
+    s += (big_integer(1) << 384) + 1;
+    EXPECT_EQ(s, (big_integer(1) << 384) + 6);
+    EXPECT_EQ(x, 5);
+
+    big_integer t = x;
+    t -= (big_integer(1) << 384) + 1;
+    EXPECT_EQ(t, -(big_integer(1) << 384) + 4);
+    t = x;
+    t.addmul(big_integer(1) << 200, big_integer(1) << 184);
+    EXPECT_EQ(t, (big_integer(1) << 384) + 5);
+}
+
+TEST(correctness, addmul_submul)
+{
+    for (int itn = 0; itn != 50; ++itn)
+    {
+        big_integer acc(random_number(1 + rand() % 200));
+        big_integer a(random_number(1 + rand() % 200));
+        big_integer b(random_number(1 + rand() % 200));
+        int c = myrand();
+
+        EXPECT_EQ(big_integer(acc).addmul(a, b), acc + a * b);
+        EXPECT_EQ(big_integer(acc).submul(a, b), acc - a * b);
+        EXPECT_EQ(big_integer(acc).addmul(a, c), acc + a * c);
+        EXPECT_EQ(big_integer(acc).submul(a, c), acc - a * c);
+    }
+
+    big_integer a("-1000000000000000000000000000000");
+    a.addmul(big_integer(10), big_integer("100000000000000000000000000000"));
+    EXPECT_EQ(a, 0);
+    a.submul(a, 7);
+    EXPECT_EQ(a, 0);
+
+    big_integer b = 3;
+    b.addmul(b, b);
+    EXPECT_EQ(b, 12);
+    b.submul(b, std::numeric_limits<int>::min());
+    EXPECT_EQ(b, big_integer("25769803788"));
+}
+
+TEST(correctness, div_burnikel_ziegler)
+{
+    std::string const a = random_number(12000), b = random_number(5000);
+    mpz_class q = mpz_class(a) / mpz_class(b);
+    EXPECT_EQ(to_string(big_integer(a) / big_integer(b)), q.get_str());
+
+    big_integer x(random_number(2000)), y(random_number(1500));
+    for (unsigned k = 1; k < 30; k += 7)
+    {
+        big_integer d = mul_by_power(y, x, k);
+        big_integer r = mul_by_power(y, x, k - 1) + 12345;
+        big_integer n = mul_by_power(d, x, 2 * k + 1) + r;
+        EXPECT_EQ(n / d, mul_by_power(1, x, 2 * k + 1));
+        EXPECT_EQ(-n / d, -mul_by_power(1, x, 2 * k + 1));
+        EXPECT_EQ(n % d, r);
+    }
+}
+
+TEST(correctness, div_newton)
+{
+    big_integer x(random_number(5000));
+    big_integer d = x;
+    for (int i = 0; i != 7; ++i)
+        d = d.square();
+    big_integer q = d + 12345;
+    big_integer r = x.square() * 7;
+    big_integer n = d * q + r;
+    EXPECT_EQ(n / d, q);
+    EXPECT_EQ(-n / d, -q);
+    EXPECT_EQ(n % d, r);
+}
+
+TEST(correctness, divmod)
+{
+    std::pair<big_integer, big_integer> r = divmod(big_integer(-7), big_integer(3));
+    EXPECT_EQ(r.first, -2);
+    EXPECT_EQ(r.second, -1);
+
+    r = divmod(big_integer(7), big_integer(-3));
+    EXPECT_EQ(r.first, -2);
+    EXPECT_EQ(r.second, 1);
+
+    r = divmod(big_integer(-3), big_integer(7));
+    EXPECT_EQ(r.first, 0);
+    EXPECT_EQ(r.second, -3);
+
+    for (size_t digits = 10; digits <= 10000; digits *= 10)
+    {
+        std::string const a = random_number(3 * digits), b = random_number(digits);
+        r = divmod(big_integer(a), big_integer(b));
+        EXPECT_EQ(to_string(r.first), mpz_class(mpz_class(a) / mpz_class(b)).get_str());
+        EXPECT_EQ(to_string(r.second), mpz_class(mpz_class(a) % mpz_class(b)).get_str());
+    }
+}
+
+TEST(correctness, big_divisor)
+{
+    for (size_t digits = 1; digits <= 10000; digits *= 5)
+    {
+        big_integer d(random_number(digits));
+        big_divisor bd(d);
+        for (size_t len = 1; len <= 4 * digits; len += digits)
+        {
+            big_integer a(random_number(len));
+            std::pair<big_integer, big_integer> expected = divmod(a, d);
+            EXPECT_EQ(bd.div(a), expected.first);
+            EXPECT_EQ(bd.mod(a), expected.second);
+            EXPECT_EQ(bd.mod(a * d), 0);
+            EXPECT_EQ(bd.div(a * d), a);
+        }
+        EXPECT_EQ(bd.div(0), 0);
+    }
+}
+
+TEST(correctness, divrem_1)
+{
+    limb_t const divisors[] = {1, 2, 3, 10, 1000000007, (limb_t)-1, (limb_t)-1 / 3};
+    for (limb_t d : divisors)
+    {
+        for (size_t digits = 1; digits <= 1000; digits *= 10)
+        {
+            big_integer a(random_number(digits));
+            std::pair<big_integer, big_integer> expected = divmod(a, big_integer(std::to_string(d)));
+            big_integer q = a;
+            limb_t r = q.divrem_1(d);
+            EXPECT_EQ(q, expected.first);
+            big_integer rem(std::to_string(r));
+            EXPECT_EQ(a < 0 ? -rem : rem, expected.second);
+        }
+    }
+}
+
+TEST(correctness, division_by_zero)
+{
+    big_integer a("123456789012345678901234567890");
+    big_integer zero = -big_integer(0);
+    EXPECT_THROW(a / zero, std::invalid_argument);
+    EXPECT_THROW(a % zero, std::invalid_argument);
+    EXPECT_THROW(divmod(a, zero), std::invalid_argument);
+    EXPECT_THROW(divexact(a, zero), std::invalid_argument);
+    EXPECT_THROW(big_divisor{zero}, std::invalid_argument);
+    EXPECT_THROW(a.divrem_1(0), std::invalid_argument);
+    EXPECT_EQ(a, big_integer("123456789012345678901234567890"));
+}
+
+TEST(correctness, montgomery_context)
+{
+    EXPECT_THROW(montgomery_context{big_integer(0)}, std::invalid_argument);
+    EXPECT_THROW(montgomery_context{big_integer("100000000000000000000000000000000")}, std::invalid_argument);
+    for (size_t digits = 1; digits <= 2000; digits *= 3)
+    {
+        big_integer m(random_number(digits) + "1");
+        if (m < 0)
+            m = -m;
+        montgomery_context ctx(m);
+        for (int i = 0; i != 5; ++i)
+        {
+            big_integer a(random_number(2 * digits)), b(random_number(digits));
+            big_integer ab = a * b % m, aa = a * a % m;
+            if (ab < 0)
+                ab += m;
+            big_integer x = ctx.to_montgomery(a), y = ctx.to_montgomery(b);
+            EXPECT_EQ(ctx.from_montgomery(ctx.multiply(x, y)), ab);
+            EXPECT_EQ(ctx.from_montgomery(ctx.square(x)), aa);
+            EXPECT_EQ(ctx.from_montgomery(ctx.multiply(x, x)), aa);
+            EXPECT_EQ(ctx.from_montgomery(y), b % m < 0 ? b % m + m : b % m);
+        }
+    }
+}
+
+TEST(correctness, pow)
+{
+    EXPECT_EQ(pow(big_integer(12345), 0), 1);
+    EXPECT_EQ(pow(big_integer(-2), 63), big_integer("-9223372036854775808"));
+    mpz_class expected;
+    mpz_pow_ui(expected.get_mpz_t(), mpz_class("-123456789").get_mpz_t(), 1000);
+    EXPECT_EQ(to_string(pow(big_integer(-123456789), 1000)), expected.get_str());
+}
+
+TEST(correctness, powmod)
+{
+    EXPECT_EQ(powmod(big_integer(3), big_integer(0), big_integer(7)), 1);
+    EXPECT_EQ(powmod(big_integer(3), big_integer(5), big_integer(1)), 0);
+    EXPECT_THROW(powmod(big_integer(3), big_integer(-5), big_integer(7)), std::invalid_argument);
+    EXPECT_EQ(powmod(big_integer(-2), big_integer(3), big_integer(10)), 2);
+    for (size_t digits = 1; digits <= 300; digits *= 7)
+    {
+        for (int odd = 0; odd != 2; ++odd)
+        {
+            std::string m = random_number(digits) + (odd ? "7" : "4");
+            std::string b = random_number(2 * digits), e = random_number(digits + 5);
+            if (e[0] == '-')
+                e = e.substr(1);
+            mpz_class expected, mm = mpz_class(m);
+            mm = abs(mm);
+            mpz_powm(expected.get_mpz_t(), mpz_class(b).get_mpz_t(), mpz_class(e).get_mpz_t(), mm.get_mpz_t());
+            EXPECT_EQ(to_string(powmod(big_integer(b), big_integer(e), big_integer(m))), expected.get_str());
+        }
+    }
+}
+
+TEST(correctness, divexact)
+{
+    EXPECT_EQ(divexact(big_integer(0), big_integer(7)), 0);
+    EXPECT_EQ(divexact(big_integer(-42), big_integer(6)), -7);
+    EXPECT_EQ(divexact(big_integer(42), big_integer(-42)), -1);
+    for (size_t digits = 1; digits <= 10000; digits *= 6)
+    {
+        big_integer q(random_number(digits)), b(random_number(digits / 2 + 1));
+        b *= mul_by_power(1, 2, (unsigned)digits % 97);
+        EXPECT_EQ(divexact(q * b, b), q);
+        EXPECT_EQ(divexact(q * b, q), b);
+    }
+    EXPECT_DEBUG_DEATH(divexact(big_integer(43), big_integer(6)), "remainder");
+}
+
+TEST(correctness, to_string_long)
+{
+    for (size_t digits = 1; digits <= 100000; digits *= 7)
+    {
+        std::string s = random_number(digits);
+        EXPECT_EQ(to_string(big_integer(s)), s);
+    }
+    for (unsigned k = 1; k <= 20000; k *= 3)
+    {
+        big_integer p = pow(big_integer(10), k);
+        EXPECT_EQ(to_string(p), "1" + std::string(k, '0'));
+        EXPECT_EQ(to_string(p - 1), std::string(k, '9'));
+        EXPECT_EQ(to_string(-p - 1), "-1" + std::string(k - 1, '0') + "1");
+    }
+}
+
+TEST(correctness, from_string_long)
+{
+    EXPECT_EQ(big_integer(std::string(5000, '0') + "12"), 12);
+    for (size_t digits = 2; digits <= 200000; digits *= 7)
+    {
+        std::string s = random_number(digits);
+        if (s[0] == '-')
+            s = s.substr(1);
+        size_t k = digits / 3 + 1;
+        big_integer expected = big_integer(s.substr(0, k)) * pow(big_integer(10), (unsigned)(digits - k));
+        expected += big_integer(s.substr(k));
+        EXPECT_EQ(big_integer(s), expected);
+        EXPECT_EQ(big_integer("-" + s), -expected);
+        EXPECT_EQ(to_string(big_integer(s)), mpz_class(s).get_str());
+    }
+}
+
+TEST(correctness, string_conv_validation)
+{
+    EXPECT_EQ(big_integer("+123"), 123);
+    EXPECT_EQ(big_integer("  -123\n"), -123);
+    EXPECT_EQ(big_integer("\t+0 "), 0);
+    EXPECT_EQ(big_integer("12345678901234567890123"), big_integer("+0012345678901234567890123"));
+    EXPECT_THROW(big_integer(""), std::invalid_argument);
+    EXPECT_THROW(big_integer("  "), std::invalid_argument);
+    EXPECT_THROW(big_integer("-"), std::invalid_argument);
+    EXPECT_THROW(big_integer("+-1"), std::invalid_argument);
+    EXPECT_THROW(big_integer("1 2"), std::invalid_argument);
+    EXPECT_THROW(big_integer("123456789012345678901234:"), std::invalid_argument);
+    try
+    {
+        big_integer(" 12345678901234/6789");
+        FAIL();
+    }
+    catch (std::invalid_argument const& e)
+    {
+        EXPECT_NE(std::string(e.what()).find("position 15"), std::string::npos);
+    }
+}
+
+TEST(correctness, to_chars)
+{
+    char buf[16];
+    char* end = to_chars(buf, buf + sizeof buf, big_integer(-255));
+    EXPECT_EQ(std::string(buf, end), "-255");
+    end = to_chars(buf, buf + sizeof buf, big_integer(-255), 16);
+    EXPECT_EQ(std::string(buf, end), "-ff");
+    end = to_chars(buf, buf + 1, big_integer(0), 2);
+    EXPECT_EQ(std::string(buf, end), "0");
+    EXPECT_EQ(to_chars(buf, buf + 3, big_integer(-255)), (char*)0);
+    EXPECT_EQ(to_chars_size(big_integer(-255)), 4u);
+    EXPECT_THROW(to_chars(buf, buf + sizeof buf, big_integer(1), 37), std::invalid_argument);
+
+    int const widths[] = {900, 1855, 1856, 1919, 1920, 1921};
+    for (int w : widths)
+    {
+        big_integer a = -(big_integer(1) << w) + 1;
+        std::string expected = to_string(a, 3);
+        std::vector<char> out(to_chars_size(a, 3));
+        end = to_chars(&out[0], &out[0] + out.size(), a, 3);
+        EXPECT_EQ(std::string(&out[0], end), expected);
+    }
+
+    int const bases[] = {2, 3, 10, 16, 36};
+    for (size_t digits = 1; digits <= 20000; digits *= 5)
+    {
+        std::string s = random_number(digits);
+        for (size_t i = 0; i != sizeof bases / sizeof bases[0]; ++i)
+        {
+            std::string expected = mpz_class(s).get_str(bases[i]);
+            big_integer a(s);
+            EXPECT_EQ(to_chars_size(a, bases[i]), expected.size());
+            std::vector<char> out(expected.size());
+            end = to_chars(&out[0], &out[0] + out.size(), a, bases[i]);
+            EXPECT_EQ(std::string(&out[0], end), expected);
+            EXPECT_EQ(to_chars(&out[0], &out[0] + out.size() - 1, a, bases[i]), (char*)0);
+        }
+    }
+}
+
+TEST(correctness, ostream_width)
+{
+    std::ostringstream out;
+    out << "[" << std::setw(6) << big_integer(42) << "][" << 7 << "]";
+    out << std::setfill('*') << std::left << std::setw(5) << big_integer(-3) << big_integer(12);
+    EXPECT_EQ(out.str(), "[    42][7]-3***12");
+
+    for (size_t digits = 240; digits <= 330; digits += 15)
+    {
+        std::string n = random_number(digits);
+        std::ostringstream long_out;
+        long_out << big_integer(n) << std::setw(digits + 3) << big_integer(n);
+        EXPECT_EQ(long_out.str(), n + std::string(digits + 3 - n.size(), ' ') + n);
+    }
+}
+
+TEST(correctness, radix_conv)
+{
+    EXPECT_EQ(to_string(big_integer(255), 16), "ff");
+    EXPECT_EQ(to_string(big_integer(-5), 2), "-101");
+    EXPECT_EQ(to_string(big_integer(0), 36), "0");
+    EXPECT_EQ(big_integer("-FF", 16), -255);
+    EXPECT_EQ(big_integer("zz", 36), 35 * 36 + 35);
+    EXPECT_THROW(big_integer("12", 2), std::invalid_argument);
+    EXPECT_THROW(big_integer("1", 1), std::invalid_argument);
+    EXPECT_THROW(to_string(big_integer(1), 37), std::invalid_argument);
+
+    int const bases[] = {2, 7, 8, 16, 32, 36};
+    for (size_t digits = 1; digits <= 50000; digits *= 6)
+    {
+        mpz_class x(random_number(digits));
+        for (size_t i = 0; i != sizeof bases / sizeof bases[0]; ++i)
+        {
+            std::string s = x.get_str(bases[i]);
+            big_integer a(s, bases[i]);
+            EXPECT_EQ(to_string(a), x.get_str());
+            EXPECT_EQ(to_string(a, bases[i]), s);
+        }
+    }
+}
+
+TEST(correctness, shift_long)
+{
+    EXPECT_EQ(big_integer(-5) << 100 >> 100, -5);
+    EXPECT_EQ(big_integer(-1) >> 1000, -1);
+    EXPECT_EQ(big_integer(7) >> 1000, 0);
+    EXPECT_EQ(-(big_integer(1) << 64) >> 64, -1);
+    EXPECT_EQ((-(big_integer(1) << 64) - 1) >> 64, -2);
+
+    int const shifts[] = {1, 31, 32, 63, 64, 65, 128, 1000};
+    for (size_t digits = 1; digits <= 5000; digits *= 5)
+    {
+        std::string s = random_number(digits);
+        big_integer a(s);
+        for (size_t i = 0; i != sizeof shifts / sizeof shifts[0]; ++i)
+        {
+            EXPECT_EQ(to_string(a << shifts[i]), mpz_class(mpz_class(s) << shifts[i]).get_str());
+            EXPECT_EQ(to_string(a >> shifts[i]), mpz_class(mpz_class(s) >> shifts[i]).get_str());
+        }
+    }
+}
+
+TEST(correctness, bitwise_long)
+{
+    EXPECT_EQ(-(big_integer(1) << 64) & -(big_integer(1) << 64), -(big_integer(1) << 64));
+    EXPECT_EQ((-(big_integer(1) << 128)) | 1, -(big_integer(1) << 128) + 1);
+
+    size_t const sizes[] = {1, 19, 20, 40, 300};
+    for (size_t i = 0; i != sizeof sizes / sizeof sizes[0]; ++i)
+    {
+        for (size_t j = 0; j != sizeof sizes / sizeof sizes[0]; ++j)
+        {
+            std::string s = random_number(sizes[i]), t = random_number(sizes[j]);
+            big_integer a(s), b(t);
+            mpz_class x(s), y(t);
+            EXPECT_EQ(to_string(a & b), mpz_class(x & y).get_str());
+            EXPECT_EQ(to_string(a | b), mpz_class(x | y).get_str());
+            EXPECT_EQ(to_string(a ^ b), mpz_class(x ^ y).get_str());
+        }
+    }
+
+    big_integer c(random_number(100));
+    big_integer d = c;
+    d &= d;
+    EXPECT_EQ(d, c);
+    d ^= d;
+    EXPECT_EQ(d, 0);
+}
+
+TEST(correctness, bit_queries)
+{
+    EXPECT_EQ(big_integer(0).bit_length(), 0u);
+    EXPECT_EQ(big_integer(-1).bit_length(), 0u);
+    EXPECT_EQ(big_integer(255).bit_length(), 8u);
+    EXPECT_EQ(big_integer(-256).bit_length(), 8u);
+    EXPECT_EQ(big_integer(-257).bit_length(), 9u);
+    EXPECT_EQ(big_integer(0).count_trailing_zeros(), 0u);
+    EXPECT_EQ(big_integer(-1).popcount(), 0u);
+    EXPECT_TRUE(big_integer(-1).test_bit(1000));
+
+    size_t const sizes[] = {1, 19, 20, 40, 300};
+    for (size_t i = 0; i != sizeof sizes / sizeof sizes[0]; ++i)
+    {
+        std::string s = random_number(sizes[i]);
+        big_integer a(s);
+        mpz_class x(s);
+        size_t len = a.bit_length();
+        EXPECT_EQ(a >> (int)len, a < 0 ? -1 : 0);
+        EXPECT_NE(a >> (int)(len - 1), a < 0 ? -1 : 0);
+        EXPECT_EQ(a.popcount(), mpz_popcount(mpz_class(a < 0 ? ~x : x).get_mpz_t()));
+        EXPECT_EQ(a.count_trailing_zeros(), mpz_scan1(x.get_mpz_t(), 0));
+        for (size_t bit = 0; bit < len + 70; bit += 1 + rand() % 13)
+        {
+            EXPECT_EQ(a.test_bit(bit), mpz_tstbit(x.get_mpz_t(), bit) != 0);
+
+            mpz_class y = x;
+            mpz_setbit(y.get_mpz_t(), bit);
+            EXPECT_EQ(to_string(big_integer(a).set_bit(bit)), y.get_str());
+            mpz_clrbit(y.get_mpz_t(), bit);
+            EXPECT_EQ(to_string(big_integer(a).clear_bit(bit)), y.get_str());
+            y = x;
+            mpz_combit(y.get_mpz_t(), bit);
+            EXPECT_EQ(to_string(big_integer(a).flip_bit(bit)), y.get_str());
+        }
+    }
+}
+
+TEST(correctness, compare_three_way)
+{
+    EXPECT_EQ(compare(big_integer(-3), big_integer(2)), -1);
+    EXPECT_EQ(compare(big_integer(3), big_integer(-2)), 1);
+    EXPECT_EQ(compare(big_integer(-3), big_integer(-2)), -1);
+    EXPECT_EQ(compare(-big_integer(0), big_integer(0)), 0);
+    EXPECT_EQ(compare(big_integer(1) << 100, (big_integer(1) << 100) + 1), -1);
+    EXPECT_EQ(compare(-(big_integer(1) << 100), big_integer(-5)), -1);
+
+    for (size_t i = 0; i != 50; ++i)
+    {
+        std::string s = random_number(1 + rand() % 40), t = random_number(1 + rand() % 40);
+        int expected = cmp(mpz_class(s), mpz_class(t));
+        expected = expected < 0 ? -1 : expected > 0 ? 1 : 0;
+        EXPECT_EQ(compare(big_integer(s), big_integer(t)), expected);
+        EXPECT_EQ(compare(big_integer(s), big_integer(s)), 0);
+    }
+}
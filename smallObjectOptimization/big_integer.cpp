@@ -1,37 +1,685 @@
 #include "big_integer.h"
 #include <string>
 #include "vector.h"
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
 
-const long long base = 1LL << 32;
+namespace {
 
-void pop_zero(vector <unsigned int>& tmp) {
+const int limb_bits = sizeof(limb_t) * 8;
+
+void pop_zero(vector <limb_t>& tmp) {
 	while (tmp.size() > 1 && tmp.back() == 0)
 		tmp.pop_back();
 }
 
-void big_integer::make_positive(big_integer& a) {
-	if (a.data.size() == 1 && a.data[0] == 0) {
-		a.isNegate = false;
+const size_t karatsuba_threshold = 32;
+
+// res[0, n) += a[0, n) * b, returns the carry limb
+limb_t addmul_1(limb_t* res, limb_t const* a, size_t n, limb_t b) {
+	double_limb_t carry = 0;
+	for (size_t i = 0; i < n; ++i) {
+		double_limb_t cur = res[i] + (double_limb_t)a[i] * b + carry;
+		res[i] = (limb_t)cur;
+		carry = cur >> limb_bits;
 	}
+	return (limb_t)carry;
 }
 
-bool big_integer::is_deg2()
-{
-	if (data.back() != 1) return 0;
-	for (size_t i = 0; i < data.size() - 1; ++i)
-		if (data[i]) return 0;
-	return 1;
+// res[0, n) -= a[0, n) * b, returns the borrow limb
+limb_t submul_1(limb_t* res, limb_t const* a, size_t n, limb_t b) {
+	limb_t borrow = 0;
+	for (size_t i = 0; i < n; ++i) {
+		double_limb_t cur = (double_limb_t)a[i] * b + borrow;
+		limb_t lo = (limb_t)cur;
+		borrow = (limb_t)(cur >> limb_bits) + (res[i] < lo);
+		res[i] -= lo;
+	}
+	return borrow;
 }
 
-void big_integer::correct()
-{
+// res[0, n + m) = a[0, n) * b[0, m)
+void mul_basecase(limb_t* res, limb_t const* a, size_t n, limb_t const* b, size_t m) {
+	std::fill(res, res + m, 0);
+	for (size_t i = 0; i < n; ++i) {
+		res[i + m] = addmul_1(res + i, b, m, a[i]);
+	}
+}
+
+// res[0, 2n) = a[0, n)^2, every cross product is computed once and doubled
+void sqr_basecase(limb_t* res, limb_t const* a, size_t n) {
+	std::fill(res, res + n, 0);
+	for (size_t i = 0; i < n; ++i) {
+		double_limb_t carry = 0;
+		for (size_t j = i + 1; j < n; ++j) {
+			double_limb_t cur = res[i + j] + (double_limb_t)a[i] * a[j] + carry;
+			res[i + j] = (limb_t)cur;
+			carry = cur >> limb_bits;
+		}
+		res[i + n] = (limb_t)carry;
+	}
+	limb_t top = 0;
+	for (size_t i = 0; i < 2 * n; ++i) {
+		limb_t cur = res[i];
+		res[i] = (cur << 1) | top;
+		top = cur >> (limb_bits - 1);
+	}
+	double_limb_t carry = 0;
+	for (size_t i = 0; i < n; ++i) {
+		double_limb_t sq = (double_limb_t)a[i] * a[i];
+		carry += res[2 * i] + (double_limb_t)(limb_t)sq;
+		res[2 * i] = (limb_t)carry;
+		carry >>= limb_bits;
+		carry += res[2 * i + 1] + (sq >> limb_bits);
+		res[2 * i + 1] = (limb_t)carry;
+		carry >>= limb_bits;
+	}
+}
+
+// res[0, n) = a[0, n) + b[0, m), n >= m, returns carry
+limb_t add_limbs(limb_t* res, limb_t const* a, size_t n, limb_t const* b, size_t m) {
+	limb_t carry = 0;
+	for (size_t i = 0; i < n; ++i) {
+		limb_t sum = a[i] + carry;
+		carry = sum < carry;
+		if (i < m) {
+			sum += b[i];
+			carry += sum < b[i];
+		}
+		res[i] = sum;
+	}
+	return carry;
+}
+
+// res[0, n) += a[0, m), n >= m, returns the carry out of res
+limb_t add_to(limb_t* res, size_t n, limb_t const* a, size_t m) {
+	limb_t carry = 0;
+	size_t i = 0;
+	for (; i < m; ++i) {
+		limb_t sum = res[i] + carry;
+		carry = sum < carry;
+		sum += a[i];
+		carry += sum < a[i];
+		res[i] = sum;
+	}
+	for (; i < n && carry; ++i) {
+		carry = ++res[i] == 0;
+	}
+	return carry;
+}
+
+// res[0, n) -= a[0, m), n >= m, returns the borrow out of res
+limb_t sub_from(limb_t* res, size_t n, limb_t const* a, size_t m) {
+	limb_t borrow = 0;
+	size_t i = 0;
+	for (; i < m; ++i) {
+		limb_t cur = res[i] - a[i] - borrow;
+		borrow = res[i] < a[i] || (res[i] == a[i] && borrow);
+		res[i] = cur;
+	}
+	for (; i < n && borrow; ++i) {
+		borrow = res[i]-- == 0;
+	}
+	return borrow;
+}
+
+// a[0, n) = -a[0, n) modulo 2^(n * limb_bits)
+void negate_limbs(limb_t* a, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		a[i] = ~a[i];
+	}
+	for (size_t i = 0; i < n && ++a[i] == 0; ++i) {
+	}
+}
+
+// r[0, n) = a[0, n) << bits for 0 < bits < limb_bits, returns the bits pushed out at the top,
+// goes from the top so r may overlap a from above
+limb_t lshift_limbs(limb_t* r, limb_t const* a, size_t n, int bits) {
+	limb_t out = a[n - 1] >> (limb_bits - bits);
+	for (size_t i = n - 1; i > 0; --i) {
+		r[i] = a[i] << bits | a[i - 1] >> (limb_bits - bits);
+	}
+	r[0] = a[0] << bits;
+	return out;
+}
+
+// r[0, n) = a[0, n) >> bits for 0 < bits < limb_bits, returns the bits pushed out at the bottom,
+// goes from the bottom so r may overlap a from below
+limb_t rshift_limbs(limb_t* r, limb_t const* a, size_t n, int bits) {
+	limb_t out = a[0] << (limb_bits - bits);
+	for (size_t i = 0; i + 1 < n; ++i) {
+		r[i] = a[i] >> bits | a[i + 1] << (limb_bits - bits);
+	}
+	r[n - 1] = a[n - 1] >> bits;
+	return out;
+}
+
+// r[0, n) = op(a, b) over the two's complement forms of a[0, n) with sign sa and b[0, m) with sign sb,
+// m <= n, turned back into a magnitude when the result is negative; the negation carries only live
+// up to the first non-zero limbs, after that the loop is plain masks, r may be a
+template <typename Op>
+void bitwise_limbs(limb_t* r, limb_t const* a, bool sa, size_t n, limb_t const* b, bool sb, size_t m, Op op) {
+	limb_t ma = -(limb_t)sa;
+	limb_t mb = -(limb_t)sb;
+	limb_t mr = op(ma, mb);
+	limb_t ca = sa, cb = sb, cr = mr & 1;
+	size_t i = 0;
+	for (; i < n && (ca | cb | cr); ++i) {
+		limb_t x = (a[i] ^ ma) + ca;
+		ca = x < ca;
+		limb_t y = ((i < m ? b[i] : 0) ^ mb) + cb;
+		cb = y < cb;
+		limb_t z = (op(x, y) ^ mr) + cr;
+		cr = z < cr;
+		r[i] = z;
+	}
+	for (; i < m; ++i) {
+		r[i] = op(a[i] ^ ma, b[i] ^ mb) ^ mr;
+	}
+	for (; i < n; ++i) {
+		r[i] = op(a[i] ^ ma, mb) ^ mr;
+	}
+}
+
+// floor((B^2 - 1) / d) - B for d with its top bit set
+limb_t invert_limb(limb_t d) {
+	return (limb_t)(~(double_limb_t)0 / d);
+}
+
+// (u1 * B + u0) / d for u1 < d, d with its top bit set and v = invert_limb(d), r receives the remainder
+limb_t div_preinv(limb_t u1, limb_t u0, limb_t d, limb_t v, limb_t& r) {
+	double_limb_t p = (double_limb_t)v * u1 + (((double_limb_t)u1 << limb_bits) | u0);
+	limb_t q = (limb_t)(p >> limb_bits) + 1;
+	limb_t rem = u0 - q * d;
+	if (rem > (limb_t)p) {
+		--q;
+		rem += d;
+	}
+	if (rem >= d) {
+		++q;
+		rem -= d;
+	}
+	r = rem;
+	return q;
+}
+
+// q[0, n) = a[0, n) / d, returns a[0, n) % d, q may be a
+limb_t divrem_1(limb_t* q, limb_t const* a, size_t n, limb_t d) {
+	assert(d != 0);
+	int shift = 0;
+	while (!((d << shift) >> (limb_bits - 1))) {
+		++shift;
+	}
+	d <<= shift;
+	limb_t v = invert_limb(d);
+	limb_t r = shift ? a[n - 1] >> (limb_bits - shift) : 0;
+	for (size_t i = n; i-- > 0; ) {
+		limb_t u0 = a[i] << shift;
+		if (shift && i) {
+			u0 |= a[i - 1] >> (limb_bits - shift);
+		}
+		q[i] = div_preinv(r, u0, d, v, r);
+	}
+	return r >> shift;
+}
+
+// b^-1 mod B for odd b, by Newton iteration doubling the number of correct low bits
+limb_t inverse_mod_limb(limb_t b) {
+	limb_t inv = b;
+	for (int bits = 3; bits < limb_bits; bits *= 2) {
+		inv *= 2 - b * inv;
+	}
+	return inv;
+}
+
+// q[0, n - m + 1) = a[0, n) / b[0, m) for odd b from the low limbs up, a is destroyed,
+// returns false if the division was not exact
+bool divexact_limbs(limb_t* q, limb_t* a, size_t n, limb_t const* b, size_t m) {
+	limb_t inv = inverse_mod_limb(b[0]);
+	size_t qn = n - m + 1;
+	limb_t lost = 0;
+	for (size_t i = 0; i < qn; ++i) {
+		q[i] = a[i] * inv;
+		limb_t borrow = submul_1(a + i, b, m, q[i]);
+		if (i + m < n) {
+			lost |= sub_from(a + i + m, n - i - m, &borrow, 1);
+		}
+		else {
+			lost |= borrow;
+		}
+	}
+	for (size_t i = qn; i < n; ++i) {
+		lost |= a[i];
+	}
+	return !lost;
+}
+
+// a[0, n) < b[0, n)
+bool less_limbs(limb_t const* a, limb_t const* b, size_t n) {
+	for (size_t i = n; i-- > 0; ) {
+		if (a[i] != b[i]) {
+			return a[i] < b[i];
+		}
+	}
+	return false;
+}
+
+// -1, 0 or 1 as a[0, n) is less than, equal to or greater than b[0, n)
+int compare_limbs(limb_t const* a, limb_t const* b, size_t n) {
+	for (size_t i = n; i-- > 0; ) {
+		if (a[i] != b[i]) {
+			return a[i] < b[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+// res[0, n) = a[0, n) - res[0, n), a must be not less than res
+void sub_reversed(limb_t* res, limb_t const* a, size_t n) {
+	limb_t borrow = 0;
+	for (size_t i = 0; i < n; ++i) {
+		limb_t cur = a[i] - res[i] - borrow;
+		borrow = a[i] < res[i] || (a[i] == res[i] && borrow);
+		res[i] = cur;
+	}
+}
+
+size_t karatsuba_buffer(size_t n) {
+	if (n < karatsuba_threshold) {
+		return 0;
+	}
+	size_t half = (n + 1) / 2 + 1;
+	return 4 * half + karatsuba_buffer(half);
+}
+
+// res[0, 2n) = a[0, n) * b[0, n), buf must hold karatsuba_buffer(n) limbs
+void karatsuba(limb_t* res, limb_t const* a, limb_t const* b, size_t n, limb_t* buf) {
+	if (n < karatsuba_threshold) {
+		mul_basecase(res, a, n, b, n);
+		return;
+	}
+	size_t lo = (n + 1) / 2;
+	size_t hi = n - lo;
+	limb_t* sa = buf;
+	limb_t* sb = sa + lo + 1;
+	limb_t* mid = sb + lo + 1;
+	limb_t* next = mid + 2 * (lo + 1);
+	karatsuba(res, a, b, lo, next);
+	karatsuba(res + 2 * lo, a + lo, b + lo, hi, next);
+	sa[lo] = add_limbs(sa, a, lo, a + lo, hi);
+	sb[lo] = add_limbs(sb, b, lo, b + lo, hi);
+	karatsuba(mid, sa, sb, lo + 1, next);
+	sub_from(mid, 2 * (lo + 1), res, 2 * lo);
+	sub_from(mid, 2 * (lo + 1), res + 2 * lo, 2 * hi);
+	add_to(res + lo, 2 * n - lo, mid, std::min(2 * (lo + 1), 2 * n - lo));
+}
+
+// res[0, 2n) = a[0, n)^2, buf must hold karatsuba_buffer(n) limbs
+void karatsuba_sqr(limb_t* res, limb_t const* a, size_t n, limb_t* buf) {
+	if (n < karatsuba_threshold) {
+		sqr_basecase(res, a, n);
+		return;
+	}
+	size_t lo = (n + 1) / 2;
+	size_t hi = n - lo;
+	limb_t* sa = buf;
+	limb_t* mid = sa + lo + 1;
+	limb_t* next = mid + 2 * (lo + 1);
+	karatsuba_sqr(res, a, lo, next);
+	karatsuba_sqr(res + 2 * lo, a + lo, hi, next);
+	sa[lo] = add_limbs(sa, a, lo, a + lo, hi);
+	karatsuba_sqr(mid, sa, lo + 1, next);
+	sub_from(mid, 2 * (lo + 1), res, 2 * lo);
+	sub_from(mid, 2 * (lo + 1), res + 2 * lo, 2 * hi);
+	add_to(res + lo, 2 * n - lo, mid, std::min(2 * (lo + 1), 2 * n - lo));
+}
+
+// res[0, 2n) = a[0, n)^2
+void sqr_limbs(limb_t* res, limb_t const* a, size_t n) {
+	if (n < karatsuba_threshold) {
+		sqr_basecase(res, a, n);
+		return;
+	}
+	vector <limb_t> buf(karatsuba_buffer(n) + 1);
+	karatsuba_sqr(res, a, n, &buf[0]);
+}
+
+const size_t toom3_threshold = 1500;
+const size_t bz_threshold = 60;
+const size_t newton_threshold = 32000;
+const size_t reciprocal_threshold = 2000;
+const size_t barrett_threshold = 360;
+const size_t divexact_threshold = 1000;
+const size_t to_string_threshold = 30;
+const size_t from_string_threshold = 30;
+
+// the characters s[0, 8) packed into a word, s[0] in the lowest byte
+unsigned long long load8(char const* s) {
+	unsigned long long x = 0;
+	for (int i = 7; i >= 0; --i) {
+		x = x << 8 | (unsigned char)s[i];
+	}
+	return x;
+}
+
+// checks all eight bytes at once: '0'..'9' are exactly the ones with 3 in both the high nibble of c and of c + 6
+bool all_digits8(unsigned long long x) {
+	unsigned long long high = x & 0xF0F0F0F0F0F0F0F0ull;
+	unsigned long long high6 = (x + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull;
+	return (high | high6 >> 4) == 0x3333333333333333ull;
+}
+
+// the value of eight packed digits, merging neighbouring lanes into 2, 4 and then 8 digit numbers
+unsigned long long parse_digits8(unsigned long long x) {
+	x -= 0x3030303030303030ull;
+	x = (x * 10 + (x >> 8)) & 0x00FF00FF00FF00FFull;
+	x = (x * 100 + (x >> 16)) & 0x0000FFFF0000FFFFull;
+	return (x * 10000 + (x >> 32)) & 0xFFFFFFFFull;
+}
+
+// the value of the digit c in either case, 36 if it is not a digit in any base
+int digit_value(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'z') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'Z') {
+		return c - 'A' + 10;
+	}
+	return 36;
+}
+
+// the length of the longest prefix of s[0, n) made of digits of base
+size_t skip_digits(char const* s, size_t n, int base) {
+	size_t i = 0;
+	if (base == 10) {
+		while (i + 8 <= n && all_digits8(load8(s + i))) {
+			i += 8;
+		}
+	}
+	while (i < n && digit_value(s[i]) < base) {
+		++i;
+	}
+	return i;
+}
+
+// the largest power of base that fits a limb and its number of digits
+limb_t radix_chunk(int base, int& digits) {
+	limb_t chunk = 1;
+	digits = 0;
+	while (chunk <= (limb_t)-1 / base) {
+		chunk *= base;
+		++digits;
+	}
+	return chunk;
+}
+
+const char radix_symbols[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+void check_base(int base) {
+	if (base < 2 || base > 36) {
+		throw std::invalid_argument("big_integer: base must be in [2, 36]");
+	}
+}
+
+// d[0, n) is a divisor in normalized form
+void check_divisor(limb_t const* d, size_t n) {
+	if (n == 1 && d[0] == 0) {
+		throw std::invalid_argument("big_integer: division by zero");
+	}
+}
+
+// the number of significant bits of x
+int bits_of(limb_t x) {
+#if defined(__GNUC__)
+	return x ? limb_bits - (sizeof(limb_t) == sizeof(unsigned int) ? __builtin_clz(x) : __builtin_clzll(x)) : 0;
+#else
+	int bits = 0;
+	while (bits < limb_bits && (x >> bits)) {
+		++bits;
+	}
+	return bits;
+#endif
+}
+
+int popcount_limb(limb_t x) {
+#if defined(__GNUC__)
+	return __builtin_popcountll(x);
+#else
+	int bits = 0;
+	for (; x; x &= x - 1) {
+		++bits;
+	}
+	return bits;
+#endif
+}
+
+// x must not be zero
+int ctz_limb(limb_t x) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(x);
+#else
+	int bits = 0;
+	for (; !(x & 1); x >>= 1) {
+		++bits;
+	}
+	return bits;
+#endif
+}
+
+// log2(base) if base is a power of two, otherwise 0
+int radix_shift(int base) {
+	return (base & (base - 1)) == 0 ? bits_of((limb_t)base) - 1 : 0;
+}
+
+// res[0, n + m) = a[0, n) * b[0, m)
+void mul_limbs(limb_t* res, limb_t const* a, size_t n, limb_t const* b, size_t m) {
+	if (n < m) {
+		std::swap(a, b);
+		std::swap(n, m);
+	}
+	if (m < karatsuba_threshold) {
+		mul_basecase(res, a, n, b, m);
+		return;
+	}
+	vector <limb_t> buf(karatsuba_buffer(m) + 1);
+	if (n == m) {
+		karatsuba(res, a, b, n, &buf[0]);
+		return;
+	}
+	vector <limb_t> part(2 * m);
+	std::fill(res, res + n + m, 0);
+	for (size_t i = 0; i < n; i += m) {
+		size_t len = std::min(m, n - i);
+		if (len == m) {
+			karatsuba(&part[0], a + i, b, m, &buf[0]);
+		}
+		else {
+			mul_limbs(&part[0], b, m, a + i, len);
+		}
+		add_to(res + i, n + m - i, &part[0], len + m);
+	}
+}
+
+// the transforms work on 32-bit pieces of the limbs
+const size_t ntt_pieces = sizeof(limb_t) / sizeof(unsigned int);
+const size_t ntt_threshold = 3500;
+const size_t ntt_max_length = 1 << 23;
+
+// primes of the form c * 2^k + 1 with primitive root 3, their product exceeds 2^86
+const unsigned int ntt_mod0 = 998244353;
+const unsigned int ntt_mod1 = 167772161;
+const unsigned int ntt_mod2 = 469762049;
+
+template <unsigned int mod>
+unsigned int pow_mod(unsigned long long a, unsigned long long e) {
+	unsigned long long res = 1;
+	for (; e; e >>= 1) {
+		if (e & 1) {
+			res = res * a % mod;
+		}
+		a = a * a % mod;
+	}
+	return (unsigned int)res;
+}
+
+// in-place transform of a[0, n), n is a power of two
+template <unsigned int mod>
+void ntt(unsigned int* a, size_t n, bool invert) {
+	for (size_t i = 1, j = 0; i < n; ++i) {
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			std::swap(a[i], a[j]);
+		}
+	}
+	for (size_t len = 2; len <= n; len <<= 1) {
+		unsigned long long wlen = pow_mod<mod>(3, (mod - 1) / len);
+		if (invert) {
+			wlen = pow_mod<mod>(wlen, mod - 2);
+		}
+		size_t half = len >> 1;
+		vector <unsigned int> w(half);
+		w[0] = 1;
+		for (size_t j = 1; j < half; ++j) {
+			w[j] = (unsigned int)(w[j - 1] * wlen % mod);
+		}
+		unsigned int const* wp = &w[0];
+		for (size_t i = 0; i < n; i += len) {
+			for (size_t j = 0; j < half; ++j) {
+				unsigned int u = a[i + j];
+				unsigned int v = (unsigned int)(a[i + j + half] * 1ULL * wp[j] % mod);
+				a[i + j] = u + v < mod ? u + v : u + v - mod;
+				a[i + j + half] = u >= v ? u - v : u + mod - v;
+			}
+		}
+	}
+	if (invert) {
+		unsigned long long inv = pow_mod<mod>(n, mod - 2);
+		for (size_t i = 0; i < n; ++i) {
+			a[i] = (unsigned int)(a[i] * inv % mod);
+		}
+	}
+}
+
+// res[0, len) = a[0, n) * b[0, m) cyclic convolution modulo mod, a == b takes a single forward transform
+template <unsigned int mod>
+void convolution(unsigned int* res, size_t len, unsigned int const* a, size_t n, unsigned int const* b, size_t m) {
+	for (size_t i = 0; i < len; ++i) {
+		res[i] = i < n ? a[i] % mod : 0;
+	}
+	ntt<mod>(res, len, false);
+	if (a == b && n == m) {
+		for (size_t i = 0; i < len; ++i) {
+			res[i] = (unsigned int)(res[i] * 1ULL * res[i] % mod);
+		}
+		ntt<mod>(res, len, true);
+		return;
+	}
+	vector <unsigned int> fb(len);
+	unsigned int* pb = &fb[0];
+	for (size_t i = 0; i < len; ++i) {
+		pb[i] = i < m ? b[i] % mod : 0;
+	}
+	ntt<mod>(pb, len, false);
+	for (size_t i = 0; i < len; ++i) {
+		res[i] = (unsigned int)(res[i] * 1ULL * pb[i] % mod);
+	}
+	ntt<mod>(res, len, true);
+}
+
+void split_pieces(vector <unsigned int>& res, limb_t const* a, size_t n) {
+	res.resize(n * ntt_pieces);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < ntt_pieces; ++j) {
+			res[i * ntt_pieces + j] = (unsigned int)(a[i] >> (32 * j));
+		}
+	}
+}
+
+// res[0, n + m) = a[0, n) * b[0, m), requires (n + m) * ntt_pieces <= ntt_max_length
+void mul_ntt(limb_t* res, limb_t const* a, size_t n, limb_t const* b, size_t m) {
+	vector <unsigned int> pa, pb;
+	split_pieces(pa, a, n);
+	unsigned int const* qa = &pa[0];
+	unsigned int const* qb = qa;
+	if (a != b || n != m) {
+		split_pieces(pb, b, m);
+		qb = &pb[0];
+	}
+	n *= ntt_pieces;
+	m *= ntt_pieces;
+	size_t len = 1;
+	while (len < n + m) {
+		len <<= 1;
+	}
+	vector <unsigned int> c0(len), c1(len), c2(len);
+	convolution<ntt_mod0>(&c0[0], len, qa, n, qb, m);
+	convolution<ntt_mod1>(&c1[0], len, qa, n, qb, m);
+	convolution<ntt_mod2>(&c2[0], len, qa, n, qb, m);
+
+	// Garner's recombination of every coefficient followed by carry propagation
+	unsigned long long const mask = UINT32_MAX;
+	unsigned long long const inv0 = pow_mod<ntt_mod1>(ntt_mod0, ntt_mod1 - 2);
+	unsigned long long const mod01 = ntt_mod0 * 1ULL * ntt_mod1;
+	unsigned long long const inv01 = pow_mod<ntt_mod2>(mod01 % ntt_mod2, ntt_mod2 - 2);
+	unsigned long long carry0 = 0, carry1 = 0, carry2 = 0;
+	for (size_t i = 0; i < n + m; ++i) {
+		unsigned long long r0 = c0[i], r1 = c1[i], r2 = c2[i];
+		unsigned long long t1 = (r1 + ntt_mod1 - r0 % ntt_mod1) * inv0 % ntt_mod1;
+		unsigned long long v = r0 + ntt_mod0 * t1;
+		unsigned long long t2 = (r2 + ntt_mod2 - v % ntt_mod2) * inv01 % ntt_mod2;
+		unsigned long long lo = (mod01 & mask) * t2;
+		unsigned long long hi = (mod01 >> 32) * t2;
+
+		unsigned long long sum = (v & mask) + (lo & mask) + carry0;
+		if (i % ntt_pieces == 0) {
+			res[i / ntt_pieces] = 0;
+		}
+		res[i / ntt_pieces] |= (limb_t)(sum & mask) << (32 * (i % ntt_pieces));
+		sum = (sum >> 32) + (v >> 32) + (lo >> 32) + (hi & mask) + carry1;
+		carry0 = sum & mask;
+		sum = (sum >> 32) + (hi >> 32) + carry2;
+		carry1 = sum & mask;
+		carry2 = sum >> 32;
+	}
+}
+
+big_integer slice(vector <limb_t> const& a, size_t from, size_t len) {
+	if (from >= a.size()) {
+		return 0;
+	}
+	vector <limb_t> tmp(std::min(len, a.size() - from));
+	for (size_t i = 0; i < tmp.size(); ++i) {
+		tmp[i] = a[from + i];
+	}
+	pop_zero(tmp);
+	return big_integer(tmp, false);
+}
+
+// B^k
+big_integer base_power(size_t k) {
+	vector <limb_t> tmp(k + 1);
+	tmp[k] = 1;
+	return big_integer(tmp, false);
+}
+
+}
 
-	while (data.size() > 1 && !data.back())
-		data.pop_back();
-	if (data.empty())
-		data.push_back(0);
-	if (!data.back())
-		isNegate = 0;
+void big_integer::make_positive(big_integer& a) {
+	if (a.data.size() == 1 && a.data[0] == 0) {
+		a.isNegate = false;
+	}
 }
 
 void big_integer::divide_by_32()
@@ -42,15 +690,15 @@ void big_integer::divide_by_32()
 	}
 }
 
-unsigned int big_integer::calculate(unsigned int a, unsigned int b, unsigned int c)
+limb_t big_integer::calculate(limb_t a, limb_t b, limb_t c)
 {
-	unsigned long long res = a;
-	res = ((res << (32ULL)) + b) / c;
-	res = std::min(res, base * 1ULL - 1);
-	return (unsigned int)res;
+	double_limb_t res = a;
+	res = ((res << limb_bits) + b) / c;
+	res = std::min(res, (double_limb_t)(limb_t)-1);
+	return (limb_t)res;
 }
 
-bool big_integer::compare_equal_vectors(vector<unsigned int> const & a, vector<unsigned int> const & b)
+bool big_integer::compare_equal_vectors(vector<limb_t> const & a, vector<limb_t> const & b)
 {
 	for (size_t i = a.size(); i > 0; i--) {
 		if (a[i - 1] != b[i - 1]) {
@@ -60,19 +708,13 @@ bool big_integer::compare_equal_vectors(vector<unsigned int> const & a, vector<u
 	return false;
 }
 
-void big_integer::sub_equal_vectors(vector<unsigned int>& a, vector<unsigned int> const & b)
+void big_integer::sub_equal_vectors(vector<limb_t>& a, vector<limb_t> const & b)
 {
-	unsigned int carry = 0;
+	limb_t carry = 0;
 	for (size_t i = 0; i < b.size(); ++i) {
-		long long sum = a[i] * 1LL - carry - b[i];
-		if (sum < 0) {
-			carry = 1;
-			a[i] = (unsigned int)(base + sum);
-		}
-		else {
-			carry = 0;
-			a[i] = (unsigned int)(sum);
-		}
+		limb_t sum = a[i] - carry - b[i];
+		carry = a[i] < b[i] || (a[i] == b[i] && carry);
+		a[i] = sum;
 	}
 }
 
@@ -84,9 +726,9 @@ big_integer big_integer::bin_pow(int n) {
 	return a;
 }
 
-unsigned int big_integer::make_normalized(big_integer& a, big_integer& b) {
-	unsigned int ret = 1;
-	unsigned int half_base = (unsigned int)1 << 31;
+limb_t big_integer::make_normalized(big_integer& a, big_integer& b) {
+	limb_t ret = 1;
+	limb_t half_base = (limb_t)1 << (limb_bits - 1);
 	while (a.data[(int)a.data.size() - 1] < half_base) {
 		a *= 2;
 		b *= 2;
@@ -95,27 +737,61 @@ unsigned int big_integer::make_normalized(big_integer& a, big_integer& b) {
 	return ret;
 }
 
-big_integer::big_integer() {
-	*this = big_integer(0);
-}
+big_integer::big_integer() : data(1, 0), isNegate(false) {}
 
 big_integer::big_integer(big_integer const& other) : data(other.data), isNegate(other.isNegate) {}
 
+// leaves other as a zero, the rest of the class relies on at least one limb
+big_integer::big_integer(big_integer&& other) noexcept : data(std::move(other.data)), isNegate(other.isNegate) {
+	other.data.resize(1);
+	other.isNegate = false;
+}
+
 big_integer::big_integer(int other) : isNegate(other < 0) {
 	long long tmp = other;
 	if (isNegate) {
 		tmp *= -1;
 	}
-	data.push_back((unsigned int)(tmp));
+	data.push_back((limb_t)(tmp));
 }
 
-big_integer::big_integer(std::string const& s) : data(), isNegate(false) {
-	std::string cur = s[0] == '-' ? s.substr(1, s.size() - 1) : s;
-	for (size_t i = 0; i < cur.size(); i++) {
-		multiply_by_const(10);
-		*this += (int)(cur[i] - '0');
+big_integer::big_integer(std::string const& s, int base) : data(), isNegate(false) {
+	check_base(base);
+	size_t start = 0, end = s.size();
+	while (start < end && isspace((unsigned char)s[start])) {
+		++start;
+	}
+	while (end > start && isspace((unsigned char)s[end - 1])) {
+		--end;
+	}
+	bool negate = start < end && s[start] == '-';
+	if (start < end && (s[start] == '-' || s[start] == '+')) {
+		++start;
+	}
+	size_t n = end - start;
+	size_t bad = start + skip_digits(s.data() + start, n, base);
+	if (n == 0 || bad != end) {
+		throw std::invalid_argument("big_integer: not a digit at position " + std::to_string(bad));
+	}
+	int chunk_digits;
+	limb_t chunk = radix_chunk(base, chunk_digits);
+	if (radix_shift(base) > 0) {
+		assign_bits(s.data() + start, n, radix_shift(base));
+	}
+	else if (n < from_string_threshold * chunk_digits) {
+		assign_digits(s.data() + start, n, base, 0, 0);
+	}
+	else {
+		big_integer powers[64];
+		powers[0] = big_integer(vector <limb_t>(1, chunk), false);
+		size_t level = 0;
+		while (((size_t)chunk_digits << (level + 1)) < n) {
+			powers[level + 1] = powers[level].square();
+			++level;
+		}
+		assign_digits(s.data() + start, n, base, powers, level);
 	}
-	isNegate = s[0] == '-';
+	isNegate = negate;
 	make_positive(*this);
 }
 
@@ -129,46 +805,53 @@ big_integer& big_integer::operator=(big_integer const& other) {
 	return *this;
 }
 
+big_integer& big_integer::operator=(big_integer&& other) noexcept {
+	swap(other);
+	return *this;
+}
 
 
-void big_integer::multiply_by_const(unsigned int cnt) {
-	unsigned int carry = 0;
-	vector <unsigned int> tmp(data);
+
+void big_integer::multiply_by_const(limb_t cnt) {
+	limb_t carry = 0;
+	vector <limb_t> tmp(data);
 	for (size_t i = 0; i < tmp.size() || carry > 0; i++) {
 		if (i == tmp.size()) {
 			tmp.push_back(0);
 		}
-		unsigned long long now = tmp[i] * 1ULL * cnt + carry;
-		tmp[i] = (unsigned int)(now % base);
-		carry = (unsigned int)(now / base);
+		double_limb_t now = (double_limb_t)tmp[i] * cnt + carry;
+		tmp[i] = (limb_t)now;
+		carry = (limb_t)(now >> limb_bits);
 	}
 	pop_zero(tmp);
-	data = tmp;
+	data.swap(tmp);
 }
 
 
 
-bool operator < (big_integer const& lhs, big_integer const& rhs) {
-	if (lhs.isNegate) {
-		if (!rhs.isNegate) {
-			return true;
-		}
-		else {
-			return rhs.compare_module(lhs, rhs);
-		}
-	}
-	else {
-		if (rhs.isNegate) {
-			return false;
-		}
-		else {
-			return rhs.compare_module(rhs, lhs);
-		}
+// zero is never negative, so numbers of different signs are never equal
+int compare(big_integer const& lhs, big_integer const& rhs) {
+	if (lhs.isNegate != rhs.isNegate) {
+		return lhs.isNegate ? -1 : 1;
 	}
+	size_t n = lhs.data.size(), m = rhs.data.size();
+	int res = n != m ? (n < m ? -1 : 1) : compare_limbs(&lhs.data[0], &rhs.data[0], n);
+	return lhs.isNegate ? -res : res;
+}
+
+#if __cplusplus > 201703L
+std::strong_ordering operator <=> (big_integer const& lhs, big_integer const& rhs) {
+	return compare(lhs, rhs) <=> 0;
+}
+#endif
+
+bool operator < (big_integer const& lhs, big_integer const& rhs) {
+	return compare(lhs, rhs) < 0;
 }
 
 bool operator == (big_integer const& lhs, big_integer const& rhs) {
-	return !(lhs > rhs) && !(lhs < rhs);
+	return lhs.isNegate == rhs.isNegate && lhs.data.size() == rhs.data.size()
+		&& memcmp(&lhs.data[0], &rhs.data[0], lhs.data.size() * sizeof(limb_t)) == 0;
 }
 
 bool operator != (big_integer const& lhs, big_integer const& rhs) {
@@ -176,68 +859,51 @@ bool operator != (big_integer const& lhs, big_integer const& rhs) {
 }
 
 bool operator > (big_integer const& lhs, big_integer const& rhs) {
-	return rhs < lhs;
+	return compare(lhs, rhs) > 0;
 }
 
 bool operator <= (big_integer const& lhs, big_integer const& rhs) {
-	return lhs < rhs || lhs == rhs;
+	return compare(lhs, rhs) <= 0;
 }
 
 bool operator >= (big_integer const& lhs, big_integer const& rhs) {
-	return !(lhs < rhs);
+	return compare(lhs, rhs) >= 0;
 }
 
 
-void big_integer::add_module(big_integer const& a, big_integer const& b, vector <unsigned int>& ret) {
-	ret = a.data;
-	unsigned int carry = 0;
-	for (size_t i = 0; i < std::max(ret.size(), b.data.size()) || carry; ++i) {
-		if (i == ret.size())
-			ret.push_back(0);
-		long long now = ret[i] * 1LL + carry + (i < b.data.size() ? b.data[i] : 0);
-		if (now >= base) {
-			carry = 1;
-			now -= base;
-		}
-		else {
-			carry = 0;
-		}
-		ret[i] = (unsigned int)(now);
+// |this| += |b|
+void big_integer::add_module(big_integer const& b) {
+	size_t m = b.data.size();
+	if (data.size() < m) {
+		data.resize(m);
+	}
+	limb_t* res = &data[0];
+	if (add_to(res, data.size(), &b.data[0], m)) {
+		data.push_back(1);
 	}
-	pop_zero(ret);
 }
 
-void big_integer::subtract_module(big_integer const& a, big_integer const& b, vector <unsigned int>& ret) {
-	ret = a.data;
-	int carry = 0;
-	for (size_t i = 0; (i < b.data.size()) || carry; ++i) {
-		long long now = ret[i] * 1LL - (carry * 1LL + (i < b.data.size() ? b.data[i] : 0));
-		if (now < 0) {
-			carry = 1;
-			now += base;
-		}
-		else {
-			carry = 0;
-		}
-		ret[i] = (unsigned int)(now);
+// |this| -= |b| if |this| >= |b|, otherwise |this| = |b| - |this| and true is returned
+bool big_integer::subtract_module(big_integer const& b) {
+	size_t m = b.data.size();
+	bool reversed = compare_module(b, *this);
+	if (reversed) {
+		data.resize(m);
+		sub_reversed(&data[0], &b.data[0], m);
 	}
-	pop_zero(ret);
+	else {
+		sub_from(&data[0], data.size(), &b.data[0], m);
+	}
+	pop_zero(data);
+	return reversed;
 }
 
 big_integer& big_integer::operator += (big_integer const& other) {
-	vector <unsigned int> tmp;
 	if (isNegate == other.isNegate) {
-		add_module(*this, other, tmp);
-		this->data = tmp;
+		add_module(other);
 	}
 	else {
-		if (compare_module(*this, other)) {
-			subtract_module(*this, other, tmp);
-			this->data = tmp;
-		}
-		else {
-			subtract_module(other, *this, tmp);
-			this->data = tmp;
+		if (subtract_module(other)) {
 			this->isNegate = other.isNegate;
 		}
 		make_positive(*this);
@@ -246,19 +912,11 @@ big_integer& big_integer::operator += (big_integer const& other) {
 }
 
 big_integer& big_integer::operator -= (big_integer const& other) {
-	vector <unsigned int> tmp;
 	if (isNegate != other.isNegate) {
-		add_module(*this, other, tmp);
-		this->data = tmp;
+		add_module(other);
 	}
 	else {
-		if (compare_module(*this, other)) {
-			subtract_module(*this, other, tmp);
-			this->data = tmp;
-		}
-		else {
-			subtract_module(other, *this, tmp);
-			this->data = tmp;
+		if (subtract_module(other)) {
 			this->isNegate = !other.isNegate;
 		}
 		make_positive(*this);
@@ -304,47 +962,51 @@ big_integer operator^(big_integer a, big_integer const & b)
 	return a;
 }
 
-void big_integer::division_by_const(unsigned int b) {
-	vector <unsigned int> a = this->data;
-	unsigned int carry = 0;
-	for (int i = (int)a.size() - 1; i >= 0; --i) {
-		unsigned long long cur = a[i] + carry * 1ULL * base;
-		a[i] = (unsigned int)(cur / b);
-		carry = (unsigned int)(cur % b);
-	}
-	pop_zero(a);
-	this->data = a;
+void big_integer::division_by_const(limb_t b) {
+	divrem_1(b);
 }
 
-void big_integer::mul_vector_by_const(vector<unsigned int>& res, vector<unsigned int> const & a, unsigned int const& b)
+// |this| /= b, returns the remainder of the magnitude
+limb_t big_integer::divrem_1(limb_t b) {
+	check_divisor(&b, 1);
+	limb_t r = ::divrem_1(&data[0], &data[0], data.size(), b);
+	pop_zero(data);
+	make_positive(*this);
+	return r;
+}
+
+void big_integer::mul_vector_by_const(vector<limb_t>& res, vector<limb_t> const & a, limb_t const& b)
 {
-	unsigned int carry = 0;
+	limb_t carry = 0;
 	size_t n = a.size();
 	res.resize(n + 1);
 	for (size_t i = 0; i < n; ++i) {
-		unsigned long long cur = carry + a[i] * 1ULL * b;
-		res[i] = (unsigned int)(cur % base);
-		carry = (unsigned int)(cur / base);
+		double_limb_t cur = carry + (double_limb_t)a[i] * b;
+		res[i] = (limb_t)cur;
+		carry = (limb_t)(cur >> limb_bits);
 	}
 	res[n] = carry;
 }
 
-big_integer big_integer::do_division(big_integer const& a, big_integer const& b) {
+// q = |a| / |b|, r = |a| % |b|
+void big_integer::do_division(big_integer const& a, big_integer const& b, big_integer& q, big_integer& r) {
 	big_integer abs_a(a.data, false);
 	big_integer abs_b(b.data, false);
 	size_t n = a.data.size();
 	size_t m = b.data.size();
 	if (m > n) {
-		return 0;
+		q = 0;
+		r = abs_a;
+		return;
 	}
-	unsigned int f = (unsigned int)((UINT32_MAX * 1ULL + 1) / (abs_b.data.back() * 1ULL + 1));
+	limb_t f = (limb_t)(((double_limb_t)1 << limb_bits) / ((double_limb_t)abs_b.data.back() + 1));
 	abs_a.multiply_by_const(f);
 	abs_b.multiply_by_const(f);
 
 	const size_t len = n - m + 1;
-	const unsigned int divisor = abs_b.data.back();
-	vector<unsigned int> temp(len);
-	vector<unsigned int> dev(m + 1), div(m + 1);
+	const limb_t divisor = abs_b.data.back();
+	vector<limb_t> temp(len);
+	vector<limb_t> dev(m + 1), div(m + 1);
 	for (size_t i = 0; i < m; i++) {
 		dev[i] = abs_a.data[n + i - m];
 	}
@@ -352,7 +1014,7 @@ big_integer big_integer::do_division(big_integer const& a, big_integer const& b)
 	for (size_t i = 0; i < len; i++) {
 		dev[0] = abs_a.data[n - m - i];
 		size_t ri = len - 1 - i;
-		unsigned int tq = calculate(dev[m], dev[m - 1], divisor);
+		limb_t tq = calculate(dev[m], dev[m - 1], divisor);
 		mul_vector_by_const(div, abs_b.data, tq);
 		while ((tq >= 0) && compare_equal_vectors(dev, div)) {
 			mul_vector_by_const(div, abs_b.data, --tq);
@@ -364,140 +1026,400 @@ big_integer big_integer::do_division(big_integer const& a, big_integer const& b)
 		temp[ri] = tq;
 	}
 	pop_zero(temp);
-	return big_integer(temp, a.isNegate ^ b.isNegate);
+	q = big_integer(temp, false);
+	// the last step has shifted the normalized remainder one limb up
+	for (size_t j = 0; j < m; j++) {
+		dev[j] = dev[j + 1];
+	}
+	dev.pop_back();
+	pop_zero(dev);
+	r = big_integer(dev, false);
+	r.division_by_const(f);
 }
 
-big_integer& big_integer::operator /= (big_integer const& other) {
-	vector <unsigned int> tmp(1);
-	if (compare_module(other, *this)) {
-		this->isNegate = false;
-		this->data = tmp;
+// |this| << (k * limb_bits)
+void big_integer::shift_limbs(size_t k) {
+	if (k == 0 || (data.size() == 1 && data[0] == 0)) {
+		return;
 	}
-	else {
-		*this = do_division(*this, other);
+	vector <limb_t> tmp(data.size() + k);
+	for (size_t i = 0; i < data.size(); ++i) {
+		tmp[i + k] = data[i];
 	}
-	return *this;
+	data.swap(tmp);
 }
 
-big_integer& big_integer::operator %= (big_integer const& other) {
-	big_integer tmp(*this);
-	*this = tmp - (tmp / other) * other;
-	return *this;
+// a < b * B^(n / 2) has at most 3n / 2 limbs, b has n limbs and is normalized
+void big_integer::divide_3n2n(big_integer const& a, big_integer const& b, size_t n, big_integer& q, big_integer& r) {
+	size_t half = n / 2;
+	big_integer a1 = slice(a.data, 2 * half, half);
+	big_integer b1 = slice(b.data, half, half);
+	big_integer r1;
+	if (compare_module(b1, a1)) {
+		divide_2n1n(slice(a.data, half, 2 * half), b1, half, q, r1);
+	}
+	else {
+		q = big_integer(vector <limb_t>(half, (limb_t)-1), false);
+		r1 = slice(a.data, half, 2 * half) + b1;
+		b1.shift_limbs(half);
+		r1 -= b1;
+	}
+	r1.shift_limbs(half);
+	r1 += slice(a.data, 0, half);
+	r1.submul(q, slice(b.data, 0, half));
+	while (r1.isNegate) {
+		r1 += b;
+		q -= 1;
+	}
+	r.swap(r1);
 }
 
-void big_integer::make_equal(size_t sz, vector<unsigned int>& tmp, vector<unsigned int>& rhs_to) {
-	while (tmp.size() < sz) {
-		tmp.push_back(0);
-	}
-	while (rhs_to.size() < sz) {
-		rhs_to.push_back(0);
+// a < b * B^n has at most 2n limbs, b has n limbs and is normalized
+void big_integer::divide_2n1n(big_integer const& a, big_integer const& b, size_t n, big_integer& q, big_integer& r) {
+	if (n % 2 || n < bz_threshold) {
+		do_division(a, b, q, r);
+		return;
 	}
+	size_t half = n / 2;
+	big_integer q1, r1;
+	divide_3n2n(slice(a.data, half, 3 * half), b, n, q1, r1);
+	r1.shift_limbs(half);
+	r1 += slice(a.data, 0, half);
+	divide_3n2n(r1, b, n, q, r);
+	q1.shift_limbs(half);
+	q += q1;
 }
 
-void big_integer::convert(vector <unsigned int>& tmp, bool sign) {
-	if (sign) {
-		for (size_t i = 0; i < tmp.size(); i++) {
-			tmp[i] = ~tmp[i];
+// Burnikel-Ziegler recursive division of magnitudes, q = |a| / |b|, r = |a| % |b|
+void big_integer::divide_bz(big_integer const& a, big_integer const& b, big_integer& q, big_integer& r) {
+	size_t s = b.data.size();
+	size_t m = 1;
+	while (m * bz_threshold <= s) {
+		m <<= 1;
+	}
+	size_t n = (s + m - 1) / m * m;
+
+	// shift both operands so that b has exactly n limbs and its top bit set
+	int bits = 0;
+	while (!((b.data.back() << bits) >> (limb_bits - 1))) {
+		++bits;
+	}
+	limb_t f = (limb_t)1 << bits;
+	big_integer bs(b.data, false), as(a.data, false);
+	bs.multiply_by_const(f);
+	bs.shift_limbs(n - s);
+	as.multiply_by_const(f);
+	as.shift_limbs(n - s);
+
+	// split as into t blocks of n limbs, the top one being less than bs / 2
+	int top_bits = 0;
+	while (top_bits < limb_bits && (as.data.back() >> top_bits)) {
+		++top_bits;
+	}
+	size_t as_bits = (as.data.size() - 1) * limb_bits + top_bits;
+	size_t t = std::max((as_bits + n * limb_bits) / (n * limb_bits), (size_t)2);
+
+	vector <limb_t> quotient(t * n);
+	big_integer z = slice(as.data, (t - 2) * n, 2 * n);
+	for (size_t i = t - 1; i > 0; --i) {
+		big_integer qi;
+		divide_2n1n(z, bs, n, qi, r);
+		for (size_t j = 0; j < qi.data.size(); ++j) {
+			quotient[(i - 1) * n + j] = qi.data[j];
 		}
-		unsigned int carry = 1;
-		for (size_t i = 0; carry > 0; i++) {
-			long long now = carry + tmp[i];
-			if (now >= base) {
-				carry = 1;
-				tmp[i] = (unsigned int)(now - base);
-			}
-			else {
-				tmp[i] = (unsigned int)(now);
-				carry = 0;
-			}
+		if (i > 1) {
+			r.shift_limbs(n);
+			r += slice(as.data, (i - 2) * n, n);
+			z.swap(r);
 		}
 	}
+	pop_zero(quotient);
+	q = big_integer(quotient, false);
+	r = slice(r.data, n - s, r.data.size());
+	r.division_by_const(f);
 }
 
-void big_integer::do_and(vector<unsigned int> & tmp, vector<unsigned int> const& rhs) {
-	for (size_t i = 0; i < tmp.size(); i++) {
-		tmp[i] = tmp[i] & rhs[i];
+// floor(B^k / b) up to a few units for k >= size(b) - 1, by Newton iteration x += x * (B^k - b * x) / B^k
+big_integer big_integer::reciprocal(big_integer const& b, size_t k) {
+	size_t n = b.data.size();
+	size_t p = k - n + 1;
+	if (n > p + 1) {
+		// only the top p + 1 limbs of b affect the result by more than a unit
+		size_t l = n - p - 1;
+		return reciprocal(slice(b.data, l, n), k - l);
+	}
+	if (p < reciprocal_threshold) {
+		big_integer x, r;
+		divide_module(base_power(k), b, x, r);
+		return x;
 	}
+	// reciprocal of p - d limbs, then one step doubling its precision
+	size_t d = (p - 2) / 2;
+	big_integer x = reciprocal(b, k - d);
+	big_integer t = base_power(k - d);
+	t.submul(x, b);
+	// t = b * (B^(k - d) / b - x) has about n limbs, only the top d + 2 of them matter
+	size_t s = n > d + 2 ? n - d - 2 : 0;
+	big_integer u = x * slice(t.data, s, t.data.size());
+	bool negative = t.isNegate;
+	u = slice(u.data, k - 2 * d - s, u.data.size());
+	x.shift_limbs(d);
+	if (negative) {
+		x -= u;
+	}
+	else {
+		x += u;
+	}
+	return x;
 }
 
-void big_integer::do_or(vector<unsigned int>& tmp, vector<unsigned int> const & rhs)
-{
-	for (size_t i = 0; i < tmp.size(); i++) {
-		tmp[i] = tmp[i] | rhs[i];
+// q = |a| / |b|, r = |a| % |b| from a reciprocal of b, for huge operands
+void big_integer::divide_newton(big_integer const& a, big_integer const& b, big_integer& q, big_integer& r) {
+	big_integer as(a.data, false), bs(b.data, false);
+	size_t k = as.data.size();
+	size_t l = bs.data.size() - 1;
+	q = reciprocal(bs, k) * slice(as.data, l, k);
+	q = slice(q.data, k - l, q.data.size());
+	r.swap(as);
+	r.submul(q, bs);
+	while (r.isNegate) {
+		r += bs;
+		q -= 1;
+	}
+	while (!compare_module(bs, r)) {
+		r -= bs;
+		q += 1;
 	}
 }
 
-void big_integer::do_xor(vector<unsigned int>& tmp, vector<unsigned int> const & rhs)
-{
-	for (size_t i = 0; i < tmp.size(); i++) {
-		tmp[i] = tmp[i] ^ rhs[i];
+// q = |a| / |b|, r = |a| % |b|, picks the division algorithm by size
+void big_integer::divide_module(big_integer const& a, big_integer const& b, big_integer& q, big_integer& r) {
+	if (b.data.size() < bz_threshold || a.data.size() < b.data.size() + bz_threshold) {
+		do_division(a, b, q, r);
 	}
+	else if (b.data.size() < newton_threshold || a.data.size() < b.data.size() + newton_threshold) {
+		divide_bz(a, b, q, r);
+	}
+	else {
+		divide_newton(a, b, q, r);
+	}
+}
+
+// *this = *this / other rounded toward zero, r = the remainder, which takes the sign of *this
+void big_integer::divide_signed(big_integer const& other, big_integer& r) {
+	check_divisor(&other.data[0], other.data.size());
+	if (compare_module(other, *this)) {
+		r = std::move(*this);
+		*this = 0;
+		return;
+	}
+	big_integer q;
+	divide_module(*this, other, q, r);
+	q.isNegate = this->isNegate ^ other.isNegate;
+	r.isNegate = this->isNegate;
+	make_positive(q);
+	make_positive(r);
+	swap(q);
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b) {
+	std::pair<big_integer, big_integer> res(a, 0);
+	res.first.divide_signed(b, res.second);
+	return res;
+}
+
+big_integer& big_integer::operator /= (big_integer const& other) {
+	big_integer r;
+	divide_signed(other, r);
+	return *this;
+}
+
+big_integer& big_integer::operator %= (big_integer const& other) {
+	*this = divmod(*this, other).second;
+	return *this;
+}
+
+// one extra limb keeps the sign bit of the result inside the width
+template <typename Op>
+big_integer& big_integer::bitwise(big_integer const& rhs, Op op) {
+	size_t m = rhs.data.size();
+	size_t n = std::max(data.size(), m) + 1;
+	bool sign = op(-(limb_t)isNegate, -(limb_t)rhs.isNegate) != 0;
+	data.resize(n);
+	bitwise_limbs(&data[0], &data[0], isNegate, n, &rhs.data[0], rhs.isNegate, m, op);
+	isNegate = sign;
+	pop_zero(data);
+	return *this;
 }
 
 big_integer & big_integer::operator&=(big_integer const & rhs)
 {
-	vector <unsigned int> tmp(this->data);
-	vector <unsigned int> rhs_to(rhs.data);
-	size_t sz = std::max(tmp.size(), rhs_to.size()) + 1;
-	make_equal(sz, tmp, rhs_to);
-	convert(tmp, this->isNegate);
-	convert(rhs_to, rhs.isNegate);
-	do_and(tmp, rhs_to);
-	bool sign = (this->isNegate) & rhs.isNegate;
-	convert(tmp, sign);
-	pop_zero(tmp);
-	this->data = tmp;
-	this->isNegate = sign;
-	return *this;
+	return bitwise(rhs, std::bit_and<limb_t>());
 }
 
 big_integer & big_integer::operator|=(big_integer const & rhs) {
-	vector <unsigned int> tmp(this->data);
-	vector <unsigned int> rhs_to(rhs.data);
-	size_t sz = std::max(tmp.size(), rhs_to.size()) + 1;
-	make_equal(sz, tmp, rhs_to);
-	convert(tmp, this->isNegate);
-	convert(rhs_to, rhs.isNegate);
-	do_or(tmp, rhs_to);
-	bool sign = (this->isNegate) | rhs.isNegate;
-	convert(tmp, sign);
-	pop_zero(tmp);
-	this->data = tmp;
-	this->isNegate = sign;
-	return *this;
+	return bitwise(rhs, std::bit_or<limb_t>());
 }
 
 big_integer & big_integer::operator^=(big_integer const & rhs)
 {
-	vector <unsigned int> tmp(this->data);
-	vector <unsigned int> rhs_to(rhs.data);
-	size_t sz = std::max(tmp.size(), rhs_to.size()) + 1;
-	make_equal(sz, tmp, rhs_to);
-	convert(tmp, this->isNegate);
-	convert(rhs_to, rhs.isNegate);
-	do_xor(tmp, rhs_to);
-	bool sign = (this->isNegate) ^ rhs.isNegate;
-	convert(tmp, sign);
-	pop_zero(tmp);
-	this->data = tmp;
-	this->isNegate = sign;
+	return bitwise(rhs, std::bit_xor<limb_t>());
+}
+
+void big_integer::toom3(vector <limb_t>& res, vector <limb_t> const& a, vector <limb_t> const& b) const {
+	size_t k = (a.size() + 2) / 3;
+	big_integer a0 = slice(a, 0, k), a1 = slice(a, k, k), a2 = slice(a, 2 * k, k);
+	big_integer b0 = slice(b, 0, k), b1 = slice(b, k, k), b2 = slice(b, 2 * k, k);
+
+	// evaluation at 0, 1, -1, -2 and infinity
+	big_integer pm1 = a0 + a2, qm1 = b0 + b2;
+	big_integer p1 = pm1 + a1, q1 = qm1 + b1;
+	pm1 -= a1;
+	qm1 -= b1;
+	big_integer pm2 = (pm1 + a2) * 2 - a0, qm2 = (qm1 + b2) * 2 - b0;
+
+	bool square = &a == &b;
+	big_integer r0 = square ? a0.square() : a0 * b0;
+	big_integer r1 = square ? p1.square() : p1 * q1;
+	big_integer rm1 = square ? pm1.square() : pm1 * qm1;
+	big_integer r3 = square ? pm2.square() : pm2 * qm2;
+	big_integer r4 = square ? a2.square() : a2 * b2;
+
+	// interpolation, all divisions are exact
+	r3 -= r1;
+	r3.division_by_const(3);
+	r1 -= rm1;
+	r1.division_by_const(2);
+	big_integer r2 = rm1 - r0;
+	r3 = r2 - r3;
+	r3.division_by_const(2);
+	r3 += r4 * 2;
+	r2 += r1;
+	r2 -= r4;
+	r1 -= r3;
+
+	big_integer const* parts[] = { &r0, &r1, &r2, &r3, &r4 };
+	res = vector <limb_t>(a.size() + b.size());
+	for (size_t i = 0; i < 5 && i * k < res.size(); ++i) {
+		vector <limb_t> const& cur = parts[i]->data;
+		add_to(&res[i * k], res.size() - i * k, &cur[0], std::min(cur.size(), res.size() - i * k));
+	}
+}
+
+void big_integer::mul_magnitude(vector <limb_t>& res, vector <limb_t> const& a, vector <limb_t> const& b) const {
+	if (a.size() < b.size()) {
+		mul_magnitude(res, b, a);
+		return;
+	}
+	size_t n = a.size(), m = b.size();
+	if (m < toom3_threshold) {
+		res.resize(n + m);
+		if (&a == &b) {
+			sqr_limbs(&res[0], &a[0], n);
+		}
+		else {
+			mul_limbs(&res[0], &a[0], n, &b[0], m);
+		}
+	}
+	else if (m >= ntt_threshold && (n + m) * ntt_pieces <= ntt_max_length) {
+		res.resize(n + m);
+		mul_ntt(&res[0], &a[0], n, &b[0], m);
+	}
+	else if (n < 2 * m) {
+		toom3(res, a, b);
+	}
+	else {
+		res = vector <limb_t>(n + m);
+		vector <limb_t> part;
+		for (size_t i = 0; i < n; i += m) {
+			big_integer block = slice(a, i, m);
+			mul_magnitude(part, block.data, b);
+			add_to(&res[i], n + m - i, &part[0], std::min(part.size(), n + m - i));
+		}
+	}
+}
+
+big_integer big_integer::square() const {
+	big_integer res;
+	mul_magnitude(res.data, this->data, this->data);
+	pop_zero(res.data);
+	return res;
+}
+
+// this += (negative ? -1 : 1) * |p|
+void big_integer::add_limbs_signed(vector <limb_t> const& p, bool negative) {
+	size_t k = p.size();
+	if (data.size() < k) {
+		data.resize(k);
+	}
+	limb_t* res = &data[0];
+	if (negative == isNegate) {
+		if (add_to(res, data.size(), &p[0], k)) {
+			data.push_back(1);
+		}
+	}
+	else if (sub_from(res, data.size(), &p[0], k)) {
+		negate_limbs(res, data.size());
+		isNegate = !isNegate;
+	}
+	pop_zero(data);
+	make_positive(*this);
+}
+
+big_integer& big_integer::addmul(big_integer const& a, big_integer const& b) {
+	vector <limb_t> p;
+	mul_magnitude(p, a.data, b.data);
+	add_limbs_signed(p, a.isNegate != b.isNegate);
 	return *this;
+}
 
+big_integer& big_integer::submul(big_integer const& a, big_integer const& b) {
+	vector <limb_t> p;
+	mul_magnitude(p, a.data, b.data);
+	add_limbs_signed(p, a.isNegate == b.isNegate);
+	return *this;
 }
 
-big_integer& big_integer::operator *= (big_integer const& other) {
-	int sz = this->data.size() + other.data.size();
-	vector <unsigned int> tmp(sz);
-	for (size_t i = 0; i < this->data.size(); ++i) {
-		unsigned int carry = 0;
-		for (int j = 0; j < (int)other.data.size() || carry; ++j) {
-			unsigned long long cur = tmp[i + j] * 1ULL + this->data[i] * 1ULL * (j < (int)other.data.size() ? other.data[j] : 0) + carry;
-			tmp[i + j] = (unsigned int)(cur % base);
-			carry = (unsigned int)(cur / base);
+// this += (negative ? -1 : 1) * |a| * b
+void big_integer::addmul_const(big_integer const& a, limb_t b, bool negative) {
+	size_t n = a.data.size();
+	if (data.size() <= n) {
+		data.resize(n + 1);
+	}
+	limb_t* res = &data[0];
+	limb_t const* src = &a.data[0];
+	if (negative == isNegate) {
+		limb_t carry = addmul_1(res, src, n, b);
+		if (add_to(res + n, data.size() - n, &carry, 1)) {
+			data.push_back(1);
 		}
 	}
+	else {
+		limb_t borrow = submul_1(res, src, n, b);
+		if (sub_from(res + n, data.size() - n, &borrow, 1)) {
+			negate_limbs(res, data.size());
+			isNegate = !isNegate;
+		}
+	}
+	pop_zero(data);
+	make_positive(*this);
+}
+
+big_integer& big_integer::addmul(big_integer const& a, int b) {
+	addmul_const(a, (limb_t)(b < 0 ? -(long long)b : b), a.isNegate != (b < 0));
+	return *this;
+}
+
+big_integer& big_integer::submul(big_integer const& a, int b) {
+	addmul_const(a, (limb_t)(b < 0 ? -(long long)b : b), a.isNegate == (b < 0));
+	return *this;
+}
+
+big_integer& big_integer::operator *= (big_integer const& other) {
+	vector <limb_t> tmp;
+	mul_magnitude(tmp, this->data, other.data);
 	pop_zero(tmp);
-	this->data = tmp;
+	this->data.swap(tmp);
 	this->isNegate = ((this->isNegate) ^ (other.isNegate));
 	make_positive(*this);
 	return *this;
@@ -521,37 +1443,240 @@ bool big_integer::compare_module(big_integer const& lhs, big_integer const& rhs)
 	return false;
 }
 
-std::string to_string(big_integer const& other) {
-	vector <unsigned int> a = other.data;
-	std::string ans = "";
-	while (true) {
-		unsigned int carry = 0;
-		for (int i = (int)a.size() - 1; i >= 0; --i) {
-			long long cur = a[i] + carry * 1ll * base;
-			a[i] = (unsigned int)(cur / 10);
-			carry = (unsigned int)(cur % 10);
+// writes the digits of |this| right to left so that they end just before end and returns where they start,
+// zero padded to at least width of them, powers[i] = chunk^(2^i) and |this| < powers[level]^2 keeps the halves balanced
+char* big_integer::write_digits(char* end, int base, big_integer const* powers, size_t level, size_t width) const {
+	int chunk_digits;
+	limb_t chunk = radix_chunk(base, chunk_digits);
+	char* stop = end - width;
+	// the high half of a split may be far shorter than the power it was split by
+	while (level > 0 && compare_module(powers[level], *this)) {
+		--level;
+	}
+	// level 0 leaves at most two limbs, so it always ends up here
+	if (data.size() < to_string_threshold) {
+		limb_t a[to_string_threshold];
+		size_t n = data.size();
+		for (size_t i = 0; i < n; ++i) {
+			a[i] = data[i];
 		}
-		while (a.size() > 1 && a.back() == 0) {
-			a.pop_back();
+		while (n > 0) {
+			limb_t r = ::divrem_1(a, a, n, chunk);
+			while (n > 0 && a[n - 1] == 0) {
+				--n;
+			}
+			for (int i = 0; i < chunk_digits && (n > 0 || r); ++i) {
+				*--end = radix_symbols[r % base];
+				r /= base;
+			}
 		}
-		ans += (char)(carry + '0');
-		if (a.size() == 1 && a[0] == 0) {
-			break;
+	}
+	else {
+		// x = q * powers[level] + r, where r takes all the digits of powers[level] - 1
+		size_t low_width = (size_t)chunk_digits << level;
+		std::pair<big_integer, big_integer> qr = divmod(*this, powers[level]);
+		end = qr.second.write_digits(end, base, powers, level - 1, low_width);
+		end = qr.first.write_digits(end, base, powers, level - 1, width > low_width ? width - low_width : 0);
+	}
+	while (end > stop) {
+		*--end = '0';
+	}
+	return end;
+}
+
+// sets |this| to the digits s[0, n) in base 2^shift, packing them into limbs from the last one
+void big_integer::assign_bits(char const* s, size_t n, int shift) {
+	vector <limb_t> a(n * shift / limb_bits + 1);
+	size_t pos = 0;
+	for (size_t i = n; i-- > 0; pos += shift) {
+		limb_t digit = digit_value(s[i]);
+		int offset = pos % limb_bits;
+		a[pos / limb_bits] |= digit << offset;
+		if (offset + shift > limb_bits) {
+			a[pos / limb_bits + 1] |= digit >> (limb_bits - offset);
+		}
+	}
+	pop_zero(a);
+	data.swap(a);
+}
+
+// splits by cached powers chunk^(2^i) and converts the halves recursively,
+// a power of two base just slices the limbs
+char* big_integer::write_digits(char* end, int base) const {
+	int shift = radix_shift(base);
+	if (data.size() == 1 && data[0] == 0) {
+		*--end = '0';
+	}
+	else if (shift > 0) {
+		size_t bits = magnitude_bits();
+		for (size_t pos = 0; pos < bits; pos += shift) {
+			size_t i = pos / limb_bits;
+			int offset = pos % limb_bits;
+			limb_t digit = data[i] >> offset;
+			if (offset + shift > limb_bits && i + 1 < data.size()) {
+				digit |= data[i + 1] << (limb_bits - offset);
+			}
+			*--end = radix_symbols[digit & (base - 1)];
+		}
+	}
+	else if (data.size() < to_string_threshold) {
+		end = write_digits(end, base, 0, 0, 0);
+	}
+	else {
+		int chunk_digits;
+		big_integer powers[64];
+		powers[0] = big_integer(vector <limb_t>(1, radix_chunk(base, chunk_digits)), false);
+		size_t level = 0;
+		while (2 * powers[level].data.size() - 1 <= data.size()) {
+			powers[level + 1] = powers[level].square();
+			++level;
 		}
+		end = write_digits(end, base, powers, level, 0);
+	}
+	if (isNegate) {
+		*--end = '-';
+	}
+	return end;
+}
+
+// at least the number of characters write_digits produces, counting every digit worth log2(base) bits rounded down
+size_t big_integer::digits_bound(int base) const {
+	return magnitude_bits() / bits_of((limb_t)base >> 1) + 2;
+}
+
+// the number of significant bits of |this|, 0 for zero
+size_t big_integer::magnitude_bits() const {
+	return (data.size() - 1) * limb_bits + bits_of(data.back());
+}
+
+// sets |this| to the digits s[0, n) in base, powers[i] = chunk^(2^i) as in write_digits
+void big_integer::assign_digits(char const* s, size_t n, int base, big_integer const* powers, size_t level) {
+	int chunk_digits;
+	limb_t chunk = radix_chunk(base, chunk_digits);
+	while (level > 0 && ((size_t)chunk_digits << level) >= n) {
+		--level;
 	}
-	if (other.isNegate) {
-		ans += '-';
+	if (level == 0 || n < from_string_threshold * chunk_digits) {
+		vector <limb_t> a(n / chunk_digits + 1);
+		size_t len = 0;
+		// the first chunk takes the digits left over by the full ones
+		size_t i = 0, next = n % chunk_digits ? n % chunk_digits : chunk_digits;
+		for (; i < n; next += chunk_digits) {
+			limb_t carry = 0;
+			for (; base == 10 && i + 8 <= next; i += 8) {
+				carry = carry * 100000000 + (limb_t)parse_digits8(load8(s + i));
+			}
+			for (; i < next; ++i) {
+				carry = carry * base + digit_value(s[i]);
+			}
+			for (size_t j = 0; j < len; ++j) {
+				double_limb_t now = (double_limb_t)a[j] * chunk + carry;
+				a[j] = (limb_t)now;
+				carry = (limb_t)(now >> limb_bits);
+			}
+			if (carry > 0) {
+				a[len++] = carry;
+			}
+		}
+		a.resize(len > 0 ? len : 1);
+		data.swap(a);
 	}
-	if (ans == "0-") {
-		ans = "0";
+	else {
+		// the low half holds exactly the digits of powers[level] - 1
+		size_t low_width = (size_t)chunk_digits << level;
+		big_integer low;
+		low.assign_digits(s + n - low_width, low_width, base, powers, level - 1);
+		assign_digits(s, n - low_width, base, powers, level - 1);
+		*this *= powers[level];
+		*this += low;
 	}
-	reverse(ans.begin(), ans.end());
+}
+
+std::string to_string(big_integer const& other, int base) {
+	check_base(base);
+	size_t n = other.digits_bound(base);
+	std::string ans(n, '0');
+	char* start = other.write_digits(&ans[0] + n, base);
+	ans.erase(0, start - &ans[0]);
 	return ans;
 }
 
+size_t to_chars_size(big_integer const& a, int base) {
+	check_base(base);
+	size_t bits = a.magnitude_bits();
+	if (radix_shift(base) > 0) {
+		size_t digits = bits > 0 ? (bits + radix_shift(base) - 1) / radix_shift(base) : 1;
+		return digits + (a.isNegate ? 1 : 0);
+	}
+	if (a.data.size() < to_string_threshold) {
+		char buf[to_string_threshold * limb_bits + 1];
+		return buf + sizeof buf - a.write_digits(buf + sizeof buf, base);
+	}
+	// |a| >= base^d for the estimate d, then count up until the power passes it
+	size_t d = (size_t)((bits - 1) * (std::log(2.0) / std::log((double)base))) - 1;
+	big_integer p = pow(big_integer(base), (unsigned)d);
+	while (!a.compare_module(p, a)) {
+		p.multiply_by_const(base);
+		++d;
+	}
+	return d + (a.isNegate ? 1 : 0);
+}
+
+// writes in place when the bound fits, otherwise fails at once if even a lower bound (one digit per
+// ceil(log2(base)) bits) does not fit; power-of-two bases know their exact size cheaply, the others
+// are written once into scratch space and copied if they fit
+char* to_chars(char* first, char* last, big_integer const& a, int base) {
+	check_base(base);
+	size_t room = last - first;
+	size_t bound = a.digits_bound(base);
+	if (room >= bound) {
+		char* start = a.write_digits(first + bound, base);
+		std::memmove(first, start, first + bound - start);
+		return first + (first + bound - start);
+	}
+	size_t bits = a.magnitude_bits();
+	if (room < bits / bits_of((limb_t)base - 1)) {
+		return 0;
+	}
+	if (radix_shift(base) > 0) {
+		size_t n = to_chars_size(a, base);
+		if (n > room) {
+			return 0;
+		}
+		a.write_digits(first + n, base);
+		return first + n;
+	}
+	// short values fit on the stack like in to_chars_size, every digit takes at least one bit
+	char small[to_string_threshold * limb_bits + 1];
+	std::string scratch;
+	char* buf = small;
+	if (a.data.size() >= to_string_threshold) {
+		scratch.resize(bound);
+		buf = &scratch[0];
+	}
+	char* start = a.write_digits(buf + bound, base);
+	size_t n = buf + bound - start;
+	if (n > room) {
+		return 0;
+	}
+	std::memcpy(first, start, n);
+	return first + n;
+}
+
 std::ostream & operator<<(std::ostream & s, big_integer const & a)
 {
-	s << to_string(a);
+	char buf[256];
+	if (a.digits_bound(10) > sizeof buf) {
+		return s << to_string(a);
+	}
+	char* end = to_chars(buf, buf + sizeof buf, a);
+	// a pending width needs the formatted insertion to pad and reset it
+	if (s.width() == 0) {
+		s.write(buf, end - buf);
+	}
+	else {
+		s << std::string(buf, end);
+	}
 	return s;
 }
 
@@ -590,13 +1715,9 @@ big_integer big_integer::operator--(int) {
 	return tmp;
 }
 
-void big_integer::swap(big_integer &a) {
-	vector <unsigned int> tmp(a.data);
-	bool isNeg = a.isNegate;
-	a.data = this->data;
-	a.isNegate = this->isNegate;
-	this->isNegate = isNeg;
-	this->data = tmp;
+void big_integer::swap(big_integer &a) noexcept {
+	this->data.swap(a.data);
+	std::swap(this->isNegate, a.isNegate);
 }
 
 big_integer big_integer::operator~() const {
@@ -606,47 +1727,172 @@ big_integer big_integer::operator~() const {
 	return tmp;
 }
 
+// moves whole limbs up and shifts the rest of the bits in the same pass, the sign stays as it is
 big_integer &big_integer::operator<<=(int rhs) {
-	int add = rhs / 32;
-	rhs %= 32;
-	vector <unsigned int> tmp(this->data);
-	add_zero(add, tmp);
-	big_integer cnt(tmp, false);
-	unsigned int more = ((unsigned int)1) << rhs;
-	cnt.multiply_by_const(more);
-	swap(cnt);
+	if (rhs <= 0 || (data.size() == 1 && data[0] == 0)) {
+		return *this;
+	}
+	size_t limbs = rhs / limb_bits;
+	int bits = rhs % limb_bits;
+	size_t n = data.size();
+	data.resize(n + limbs + 1);
+	limb_t* d = &data[0];
+	if (bits > 0) {
+		d[n + limbs] = lshift_limbs(d + limbs, d, n, bits);
+	}
+	else {
+		std::copy_backward(d, d + n, d + n + limbs);
+	}
+	std::fill(d, d + limbs, 0);
+	pop_zero(data);
 	return *this;
 }
 
-void big_integer::add_zero(int add, vector<unsigned int> & now) {
-	vector <unsigned int> tmp;
-	for (int i = 0; i < add; i++)
-		tmp.push_back(0);
-	for (size_t i = 0; i < now.size(); ++i) {
-		tmp.push_back(now[i]);
+big_integer::big_integer(vector<limb_t> const &a, bool sign) :data(a), isNegate(sign) {}
+
+// rounds towards minus infinity like the two's complement shift: a negative number whose dropped bits
+// are not all zero moves one further away from zero
+big_integer &big_integer::operator>>=(int rhs) {
+	if (rhs <= 0) {
+		return *this;
+	}
+	size_t limbs = rhs / limb_bits;
+	int bits = rhs % limb_bits;
+	size_t n = data.size();
+	if (limbs >= n) {
+		data.resize(1);
+		data[0] = isNegate ? 1 : 0;
+		return *this;
 	}
-	now = tmp;
+	limb_t* d = &data[0];
+	bool inexact = false;
+	for (size_t i = 0; i < limbs; ++i) {
+		inexact |= d[i] != 0;
+	}
+	if (bits > 0) {
+		inexact |= rshift_limbs(d, d + limbs, n - limbs, bits) != 0;
+	}
+	else {
+		std::copy(d + limbs, d + n, d);
+	}
+	data.resize(n - limbs);
+	pop_zero(data);
+	if (isNegate && inexact) {
+		*this -= 1;
+	}
+	make_positive(*this);
+	return *this;
 }
 
-big_integer::big_integer(vector<unsigned int> const &a, bool sign) :data(a), isNegate(sign) {}
+// the bit queries below look at the number as an infinite two's complement string, like the bitwise operators do;
+// a negative -m is ~(m - 1), so its bits are read off m without building m - 1
 
-big_integer &big_integer::operator>>=(int rhs) {
-	int complete = rhs >> 5;
-	rhs &= 31;
-	big_integer ans(*this);
-	unsigned int tmp = 0;
-	for (size_t i = this->data.size() - 1; ; --i) {
-		unsigned int digit = ans.data[i];
-		ans.data[i] = (tmp << (32 - rhs)) + (ans.data[i] >> rhs);
-		tmp = digit & ((1ll << rhs) - 1);
-		if (!i) break;
-	}
-	ans.correct();
-	if (!is_deg2() && this->isNegate) ans -= 1;
-	this->swap(ans);
+size_t big_integer::first_nonzero_limb() const {
+	size_t k = 0;
+	while (k + 1 < data.size() && data[k] == 0) {
+		++k;
+	}
+	return k;
+}
+
+// bits besides the sign bit, a >> bit_length() is 0 or -1
+size_t big_integer::bit_length() const {
+	size_t n = data.size();
+	size_t bits = magnitude_bits();
+	if (isNegate && first_nonzero_limb() == n - 1 && (data[n - 1] & (data[n - 1] - 1)) == 0) {
+		--bits;
+	}
+	return bits;
+}
+
+// set bits of a non-negative number, bits that differ from the sign bit of a negative one
+size_t big_integer::popcount() const {
+	size_t k = isNegate ? first_nonzero_limb() : 0;
+	size_t bits = isNegate ? k * limb_bits + popcount_limb(data[k] - 1) : popcount_limb(data[0]);
+	for (size_t i = k + 1; i < data.size(); ++i) {
+		bits += popcount_limb(data[i]);
+	}
+	return bits;
+}
+
+// 0 for zero
+size_t big_integer::count_trailing_zeros() const {
+	size_t k = first_nonzero_limb();
+	return data[k] ? k * limb_bits + ctz_limb(data[k]) : 0;
+}
+
+bool big_integer::test_bit(size_t i) const {
+	size_t j = i / limb_bits;
+	if (j >= data.size()) {
+		return isNegate;
+	}
+	limb_t x = data[j];
+	if (isNegate) {
+		x = first_nonzero_limb() < j ? ~x : -x;
+	}
+	return (x >> (i % limb_bits)) & 1;
+}
+
+big_integer& big_integer::set_bit(size_t i) {
+	if (isNegate) {
+		invert();
+		assign_magnitude_bit(i, false);
+		invert();
+	}
+	else {
+		assign_magnitude_bit(i, true);
+	}
 	return *this;
 }
 
+big_integer& big_integer::clear_bit(size_t i) {
+	if (isNegate) {
+		invert();
+		assign_magnitude_bit(i, true);
+		invert();
+	}
+	else {
+		assign_magnitude_bit(i, false);
+	}
+	return *this;
+}
+
+big_integer& big_integer::flip_bit(size_t i) {
+	return test_bit(i) ? clear_bit(i) : set_bit(i);
+}
+
+// this = ~this = -this - 1 in place, the carry stops at the first limb it does not wrap
+void big_integer::invert() {
+	limb_t one = 1;
+	if (isNegate) {
+		sub_from(&data[0], data.size(), &one, 1);
+		pop_zero(data);
+	}
+	else if (add_to(&data[0], data.size(), &one, 1)) {
+		data.push_back(1);
+	}
+	isNegate = !isNegate;
+	make_positive(*this);
+}
+
+void big_integer::assign_magnitude_bit(size_t i, bool value) {
+	size_t j = i / limb_bits;
+	limb_t mask = (limb_t)1 << (i % limb_bits);
+	if (j >= data.size()) {
+		if (!value) {
+			return;
+		}
+		data.resize(j + 1);
+	}
+	if (value) {
+		data[j] |= mask;
+	}
+	else {
+		data[j] &= ~mask;
+		pop_zero(data);
+	}
+}
+
 big_integer operator / (big_integer lhs, big_integer const& rhs) {
 	lhs /= rhs;
 	return lhs;
@@ -662,4 +1908,286 @@ big_integer operator>>(big_integer lhs, int rhs)
 {
 	lhs >>= rhs;
 	return lhs;
+}
+
+big_divisor::big_divisor(big_integer const& d) : value(d), n(d.data.size()), negative(d.isNegate) {
+	check_divisor(&d.data[0], n);
+	if (n >= barrett_threshold) {
+		return;
+	}
+	int bits = 0;
+	while (!((d.data.back() << bits) >> (limb_bits - 1))) {
+		++bits;
+	}
+	f = (limb_t)1 << bits;
+	big_integer ds(d.data, false);
+	ds.multiply_by_const(f);
+	divisor = ds.data;
+	// ds >= B^n / 2, so the inverse is at most 2 * B^n and fits n + 1 limbs
+	big_integer inv = base_power(2 * n) / ds;
+	vector <limb_t> tmp(n + 1);
+	for (size_t i = 0; i < inv.data.size(); ++i) {
+		tmp[i] = inv.data[i];
+	}
+	inverse.swap(tmp);
+}
+
+// q[0, n) = a[0, 2n) / d, a[0, n) = a[0, 2n) % d for a < d * B^n, buf must hold 2n + 2 limbs
+void big_divisor::divide_block(limb_t* a, limb_t* q, limb_t* buf) const {
+	limb_t const* d = &divisor[0];
+	// the estimate from the top n + 1 limbs is at most two units low
+	mul_limbs(buf, a + n - 1, n + 1, &inverse[0], n + 1);
+	for (size_t i = 0; i < n; ++i) {
+		q[i] = buf[n + 1 + i];
+	}
+	mul_limbs(buf, q, n, d, n);
+	sub_from(a, 2 * n, buf, 2 * n);
+	while (a[n] || !less_limbs(a, d, n)) {
+		a[n] -= sub_from(a, n, d, n);
+		for (size_t i = 0; i < n && !++q[i]; ++i) {}
+	}
+}
+
+// same results as ::divmod(a, d), one n-limb block of the quotient per step
+std::pair<big_integer, big_integer> big_divisor::divmod(big_integer const& a) const {
+	if (n >= barrett_threshold) {
+		return ::divmod(a, value);
+	}
+	big_integer as(a.data, false);
+	as.multiply_by_const(f);
+	size_t t = (as.data.size() + n - 1) / n;
+	vector <limb_t> quotient(t * n), cur(2 * n), buf(2 * n + 2);
+	for (size_t i = t; i-- > 0; ) {
+		for (size_t j = 0; j < n; ++j) {
+			cur[n + j] = cur[j];
+			cur[j] = i * n + j < as.data.size() ? as.data[i * n + j] : 0;
+		}
+		// a short top block is already a remainder
+		if (i + 1 < t || !less_limbs(&cur[0], &divisor[0], n)) {
+			divide_block(&cur[0], &quotient[i * n], &buf[0]);
+		}
+	}
+	pop_zero(quotient);
+	cur.resize(n);
+	pop_zero(cur);
+	std::pair<big_integer, big_integer> res(big_integer(quotient, a.isNegate ^ negative), big_integer(cur, a.isNegate));
+	res.second.division_by_const(f);
+	res.first.make_positive(res.first);
+	res.second.make_positive(res.second);
+	return res;
+}
+
+big_integer big_divisor::div(big_integer const& a) const {
+	return divmod(a).first;
+}
+
+big_integer big_divisor::mod(big_integer const& a) const {
+	return divmod(a).second;
+}
+
+montgomery_context::montgomery_context(big_integer const& m) : modulus(m.data, false), n(m.data.size()) {
+	// zero is even as well
+	if (!(modulus.data[0] & 1)) {
+		throw std::invalid_argument("montgomery_context: the modulus must be odd");
+	}
+	m_inv = 0 - inverse_mod_limb(modulus.data[0]);
+	r2 = base_power(2 * n) % modulus;
+}
+
+// t[0, 2n) * R^-1 mod m for t < m * R
+big_integer montgomery_context::redc(vector <limb_t>& t) const {
+	t.resize(2 * n + 1);
+	limb_t const* m = &modulus.data[0];
+	for (size_t i = 0; i < n; ++i) {
+		limb_t carry = addmul_1(&t[i], m, n, t[i] * m_inv);
+		add_to(&t[i + n], n + 1 - i, &carry, 1);
+	}
+	for (size_t i = 0; i <= n; ++i) {
+		t[i] = t[i + n];
+	}
+	t.resize(n + 1);
+	if (t[n] || !less_limbs(&t[0], m, n)) {
+		sub_from(&t[0], n + 1, m, n);
+	}
+	pop_zero(t);
+	return big_integer(t, false);
+}
+
+big_integer montgomery_context::to_montgomery(big_integer const& a) const {
+	big_integer r = a % modulus;
+	if (r.isNegate) {
+		r += modulus;
+	}
+	return multiply(r, r2);
+}
+
+big_integer montgomery_context::from_montgomery(big_integer const& a) const {
+	vector <limb_t> t(a.data.size());
+	for (size_t i = 0; i < t.size(); ++i) {
+		t[i] = a.data[i];
+	}
+	return redc(t);
+}
+
+// residues in Montgomery form, a * b * R^-1 mod m
+big_integer montgomery_context::multiply(big_integer const& a, big_integer const& b) const {
+	if (&a == &b) {
+		return square(a);
+	}
+	vector <limb_t> t(a.data.size() + b.data.size());
+	mul_limbs(&t[0], &a.data[0], a.data.size(), &b.data[0], b.data.size());
+	return redc(t);
+}
+
+big_integer montgomery_context::square(big_integer const& a) const {
+	vector <limb_t> t(2 * a.data.size());
+	sqr_limbs(&t[0], &a.data[0], a.data.size());
+	return redc(t);
+}
+
+big_integer pow(big_integer const& base, unsigned exp) {
+	if (exp == 0) {
+		return 1;
+	}
+	int i = 31;
+	while (!((exp >> i) & 1)) {
+		--i;
+	}
+	big_integer res = base;
+	while (i-- > 0) {
+		res = res.square();
+		if ((exp >> i) & 1) {
+			res *= base;
+		}
+	}
+	return res;
+}
+
+namespace {
+
+// reduction by a big_divisor, for even moduli
+struct barrett_ring {
+	big_divisor d;
+
+	big_integer multiply(big_integer const& a, big_integer const& b) const {
+		return d.mod(a * b);
+	}
+
+	big_integer square(big_integer const& a) const {
+		return d.mod(a.square());
+	}
+};
+
+// bit i of a magnitude
+bool test_limb_bit(vector <limb_t> const& a, size_t i) {
+	return (a[i / limb_bits] >> (i % limb_bits)) & 1;
+}
+
+// x^e with left-to-right sliding windows, the ring keeps x and one in its own representation
+template <typename Ring>
+big_integer sliding_window_pow(Ring const& ring, big_integer const& x, vector <limb_t> const& e, big_integer const& one) {
+	size_t bits = e.size() * limb_bits;
+	while (bits > 0 && !test_limb_bit(e, bits - 1)) {
+		--bits;
+	}
+	size_t k = bits <= 7 ? 1 : bits <= 25 ? 2 : bits <= 81 ? 3 : bits <= 241 ? 4 : bits <= 673 ? 5 : 6;
+	// odd powers x, x^3, ..., x^(2^k - 1)
+	big_integer table[1 << 5];
+	table[0] = x;
+	big_integer x2 = ring.square(x);
+	for (size_t i = 1; i < ((size_t)1 << (k - 1)); ++i) {
+		table[i] = ring.multiply(table[i - 1], x2);
+	}
+	big_integer res = one;
+	bool started = false;
+	size_t i = bits;
+	while (i > 0) {
+		if (!test_limb_bit(e, i - 1)) {
+			res = ring.square(res);
+			--i;
+			continue;
+		}
+		// the longest window of at most k bits that ends with a one
+		size_t len = std::min(k, i);
+		while (!test_limb_bit(e, i - len)) {
+			--len;
+		}
+		size_t w = 0;
+		for (size_t j = 0; j < len; ++j) {
+			if (started) {
+				res = ring.square(res);
+			}
+			w = 2 * w + test_limb_bit(e, i - 1 - j);
+		}
+		res = started ? ring.multiply(res, table[w >> 1]) : table[w >> 1];
+		started = true;
+		i -= len;
+	}
+	return res;
+}
+
+}
+
+// base^exp mod |mod| in [0, |mod|) for exp >= 0
+big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod) {
+	if (exp.isNegate) {
+		throw std::invalid_argument("powmod: negative exponent");
+	}
+	big_integer m(mod.data, false);
+	if (m == 1) {
+		return 0;
+	}
+	if (mod.data[0] & 1) {
+		montgomery_context ctx(m);
+		return ctx.from_montgomery(sliding_window_pow(ctx, ctx.to_montgomery(base), exp.data, ctx.to_montgomery(1)));
+	}
+	big_integer x = base % m;
+	if (x < 0) {
+		x += m;
+	}
+	barrett_ring ring = {big_divisor(m)};
+	return sliding_window_pow(ring, x, exp.data, 1);
+}
+
+// a / b for a known to be a multiple of b, the remainder is checked in debug builds only
+big_integer divexact(big_integer const& a, big_integer const& b) {
+	check_divisor(&b.data[0], b.data.size());
+	if (b.data.size() >= divexact_threshold && a.data.size() >= b.data.size() + divexact_threshold) {
+		// long operands are cheaper through the subquadratic division
+		std::pair<big_integer, big_integer> qr = divmod(a, b);
+		assert(qr.second == 0 && "divexact: the remainder is not zero");
+		return qr.first;
+	}
+	// the trailing zeros of b are shared by a
+	size_t z = 0;
+	while (z + 1 < b.data.size() && b.data[z] == 0) {
+		++z;
+	}
+	bool exact = true;
+	for (size_t i = 0; i < z && i < a.data.size(); ++i) {
+		exact &= a.data[i] == 0;
+	}
+	big_integer as = slice(a.data, z, a.data.size()), bs = slice(b.data, z, b.data.size());
+	int bits = 0;
+	while (!((bs.data[0] >> bits) & 1)) {
+		++bits;
+	}
+	if (bits) {
+		exact &= (as.data[0] & (((limb_t)1 << bits) - 1)) == 0;
+		as.division_by_const((limb_t)1 << bits);
+		bs.division_by_const((limb_t)1 << bits);
+	}
+	size_t n = as.data.size(), m = bs.data.size();
+	if (n < m) {
+		assert(exact && as == 0 && "divexact: the remainder is not zero");
+		return 0;
+	}
+	vector <limb_t> q(n - m + 1);
+	exact &= divexact_limbs(&q[0], &as.data[0], n, &bs.data[0], m);
+	assert(exact && "divexact: the remainder is not zero");
+	(void)exact;
+	pop_zero(q);
+	big_integer res(q, a.isNegate ^ b.isNegate);
+	res.make_positive(res);
+	return res;
 }
\ No newline at end of file
@@ -78,8 +78,10 @@ struct vector {
 
 	vector(size_t n = 0);
 	vector(vector const&);
+	vector(vector&&) noexcept;
 	vector(int, T);
 	vector& operator=(vector const&);
+	vector& operator=(vector&&) noexcept;
 	~vector();
 
 	bool is_small() const;
@@ -90,8 +92,10 @@ struct vector {
 	void push_back(T const&);
 	void clear();
 	T& back();
+	T const& back() const;
 	T& operator[](size_t);
 	T const& operator[](size_t) const;
+	void swap(vector&) noexcept;
 
 private:
 
@@ -121,8 +125,15 @@ vector<T>::vector(vector const& other) : vector(0)
 	*this = other;
 }
 
+template <typename T>
+vector<T>::vector(vector&& other) noexcept
+{
+	memcpy(this, &other, sizeof(vector));
+	other.small_object.magic = 1;
+}
+
 template<typename T>
-vector<T>::vector(int n, T element)
+vector<T>::vector(int n, T element) : vector(0)
 {
 	resize(n);
 	for (int i = 0; i < n; ++i) {
@@ -141,6 +152,13 @@ vector<T>& vector<T>::operator=(vector const& other)
 	return *this;
 }
 
+template <typename T>
+vector<T>& vector<T>::operator=(vector&& other) noexcept
+{
+	swap(other);
+	return *this;
+}
+
 template <typename T>
 vector<T>::~vector()
 {
@@ -177,6 +195,9 @@ void vector<T>::resize(size_t n)
 			small_object.magic = 1 | (n << 1);
 		}
 		else {
+			for (size_t i = size(); i < n; ++i) {
+				big_object[i] = 0;
+			}
 			big_object.size_ = n;
 			big_to_small();
 		}
@@ -222,6 +243,12 @@ T& vector<T>::back()
 	return (*this)[size() - 1];
 }
 
+template <typename T>
+T const& vector<T>::back() const
+{
+	return (*this)[size() - 1];
+}
+
 template <typename T>
 T& vector<T>::operator[](size_t i)
 {
@@ -235,6 +262,15 @@ T const& vector<T>::operator[](size_t i) const
 	return is_small() ? small_object[i] : big_object[i];
 }
 
+template <typename T>
+void vector<T>::swap(vector& other) noexcept
+{
+	char tmp[sizeof(vector)];
+	memcpy(tmp, this, sizeof(vector));
+	memcpy(this, &other, sizeof(vector));
+	memcpy((void*)&other, tmp, sizeof(vector));
+}
+
 template <typename T>
 void vector<T>::check_refs()
 {